@@ -21,4 +21,13 @@ void AbstractInterface::setMaskArea(QRect area)
     m_maskArea = area;
 }
 
+void AbstractInterface::setScreenGeometry(QRect geometry)
+{
+    if (m_screenGeometry == geometry) {
+        return;
+    }
+
+    m_screenGeometry = geometry;
+}
+
 }
@@ -30,16 +30,25 @@ public:
     virtual void showDockOnBottom() = 0;
     virtual void showDockOnTop() = 0;
 
-    void setMaskArea(QRect area);
+    virtual void setMaskArea(QRect area);
+    //the geometry of the screen of the dock, only its windows can cover the dock
+    virtual void setScreenGeometry(QRect geometry);
+    //sets only the region of the dock that accepts input, a null area resets it
+    //to the whole window
+    virtual void setInputMask(QRect area) = 0;
 
 Q_SIGNALS:
     void activeWindowChanged();
+    //the dock has been moved to another layer, e.g. it is on top of the windows now
+    void dockStateChanged();
     void windowInAttention(bool);
-    //FIXME: there is a chance that this signal is not needed at all
+    //a window change that can affect the dock visibility, it is sent
+    //once for a burst of changes
     void windowChanged();
 
 protected:
     QRect m_maskArea;
+    QRect m_screenGeometry;
 
     QQuickWindow *m_dockWindow;
 };
@@ -0,0 +1,138 @@
+#include "appletgeometryindex.h"
+
+#include <QQuickItem>
+
+#include <algorithm>
+
+namespace NowDock
+{
+
+AppletGeometryIndex::AppletGeometryIndex(Qt::Orientation orientation) :
+    m_orientation(orientation)
+{
+}
+
+Qt::Orientation AppletGeometryIndex::orientation() const
+{
+    return m_orientation;
+}
+
+void AppletGeometryIndex::setOrientation(Qt::Orientation orientation)
+{
+    if (m_orientation == orientation) {
+        return;
+    }
+
+    m_orientation = orientation;
+
+    sort();
+}
+
+void AppletGeometryIndex::clear()
+{
+    m_entries.clear();
+}
+
+void AppletGeometryIndex::insert(QQuickItem *item, int index)
+{
+    if (!item) {
+        return;
+    }
+
+    Entry entry;
+    entry.item = item;
+    entry.index = index;
+
+    m_entries.insert(upperBound(start(item)), entry);
+}
+
+void AppletGeometryIndex::remove(QObject *item)
+{
+    for (int i=0; i<m_entries.count(); ++i) {
+        if (m_entries.at(i).item == item) {
+            m_entries.remove(i);
+            return;
+        }
+    }
+}
+
+void AppletGeometryIndex::sort()
+{
+    //the starts are read once, the items are mapped to the scene for each of them
+    QVector<QPair<int, Entry> > entries;
+    entries.reserve(m_entries.count());
+
+    foreach (const Entry &entry, m_entries) {
+        entries.append(qMakePair(start(entry.item), entry));
+    }
+
+    std::stable_sort(entries.begin(), entries.end(), [](const QPair<int, Entry> &a, const QPair<int, Entry> &b) {
+        return a.first < b.first;
+    });
+
+    for (int i=0; i<entries.count(); ++i) {
+        m_entries[i] = entries.at(i).second;
+    }
+}
+
+QQuickItem *AppletGeometryIndex::itemAt(const QPoint &point, int *index) const
+{
+    int coordinate = (m_orientation == Qt::Horizontal) ? point.x() : point.y();
+
+    if (index) {
+        *index = -1;
+    }
+
+    //the intervals don't overlap, so the last one that starts before
+    //the point is the only one that can contain it
+    int i = upperBound(coordinate) - 1;
+
+    if (i < 0) {
+        return 0;
+    }
+
+    const Entry &entry = m_entries.at(i);
+
+    if (!geometry(entry.item).contains(point)) {
+        return 0;
+    }
+
+    if (index) {
+        *index = entry.index;
+    }
+
+    return entry.item;
+}
+
+//the scene of the dock is its window, so this is the geometry in the window
+QRect AppletGeometryIndex::geometry(const QQuickItem *item) const
+{
+    return item->mapRectToScene(item->boundingRect()).toAlignedRect();
+}
+
+int AppletGeometryIndex::start(const QQuickItem *item) const
+{
+    QRect rect = geometry(item);
+
+    return (m_orientation == Qt::Horizontal) ? rect.left() : rect.top();
+}
+
+int AppletGeometryIndex::upperBound(int coordinate) const
+{
+    int first = 0;
+    int last = m_entries.count();
+
+    while (first < last) {
+        int middle = (first + last) / 2;
+
+        if (start(m_entries.at(middle).item) <= coordinate) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    return first;
+}
+
+}
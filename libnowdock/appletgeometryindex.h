@@ -0,0 +1,61 @@
+#ifndef APPLETGEOMETRYINDEX_H
+#define APPLETGEOMETRYINDEX_H
+
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+
+class QObject;
+class QQuickItem;
+
+namespace NowDock
+{
+
+/*
+ * Index for the applets in the window of the dock. The applets of a dock
+ * don't overlap along its axis, so they are kept sorted by the start of
+ * their interval on that axis and the applet under a point is found with
+ * a binary search. Only the order of the items is stored, their geometries
+ * are read while searching, so the index stays valid while the applets are
+ * resized or pushed by their neighbours, e.g. during the zoom, and it must
+ * be sorted again only when the applets have been moved in the layouts.
+ * The items can be the applets themselves or their containers together
+ * with their index in the layouts.
+ */
+class AppletGeometryIndex {
+public:
+    explicit AppletGeometryIndex(Qt::Orientation orientation = Qt::Horizontal);
+
+    Qt::Orientation orientation() const;
+    void setOrientation(Qt::Orientation orientation);
+
+    void clear();
+    //the item is placed by its current geometry, it must not be in the index already
+    void insert(QQuickItem *item, int index = -1);
+    void remove(QObject *item);
+    //places the items again by their current geometries
+    void sort();
+
+    //index is set to the index of the item, -1 if there isn't any item
+    QQuickItem *itemAt(const QPoint &point, int *index = 0) const;
+
+private:
+    struct Entry {
+        QQuickItem *item;
+        int index;
+    };
+
+    Qt::Orientation m_orientation;
+
+    //sorted by start()
+    QVector<Entry> m_entries;
+
+    QRect geometry(const QQuickItem *item) const;
+    int start(const QQuickItem *item) const;
+    //the first entry that starts after the coordinate
+    int upperBound(int coordinate) const;
+};
+
+}
+
+#endif
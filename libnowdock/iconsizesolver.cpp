@@ -0,0 +1,271 @@
+#include "iconsizesolver.h"
+
+#include <QtMath>
+
+namespace NowDock
+{
+
+IconSizeSolver::IconSizeSolver(QObject *parent) :
+    QObject(parent),
+    m_enabled(false),
+    m_zoomed(false),
+    m_automaticIconSize(-1),
+    m_iconSize(0),
+    m_maximumLength(0),
+    m_maximumSize(64),
+    m_minimumSize(16),
+    m_step(8),
+    m_iconMargin(0),
+    m_layoutLength(0),
+    m_zoomFactor(1)
+{
+    m_solveTimer.setSingleShot(true);
+    m_solveTimer.setInterval(0);
+    connect(&m_solveTimer, &QTimer::timeout, this, &IconSizeSolver::solve);
+}
+
+IconSizeSolver::~IconSizeSolver()
+{
+}
+
+bool IconSizeSolver::enabled() const
+{
+    return m_enabled;
+}
+
+void IconSizeSolver::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) {
+        return;
+    }
+
+    m_enabled = enabled;
+    update();
+
+    emit enabledChanged();
+}
+
+bool IconSizeSolver::zoomed() const
+{
+    return m_zoomed;
+}
+
+void IconSizeSolver::setZoomed(bool zoomed)
+{
+    if (m_zoomed == zoomed) {
+        return;
+    }
+
+    m_zoomed = zoomed;
+    update();
+
+    emit zoomedChanged();
+}
+
+int IconSizeSolver::iconSize() const
+{
+    return m_iconSize;
+}
+
+void IconSizeSolver::setIconSize(int size)
+{
+    if (m_iconSize == size) {
+        return;
+    }
+
+    m_iconSize = size;
+    update();
+
+    emit iconSizeChanged();
+}
+
+qreal IconSizeSolver::iconMargin() const
+{
+    return m_iconMargin;
+}
+
+void IconSizeSolver::setIconMargin(qreal margin)
+{
+    if (qFuzzyCompare(m_iconMargin, margin)) {
+        return;
+    }
+
+    m_iconMargin = margin;
+    update();
+
+    emit iconMarginChanged();
+}
+
+qreal IconSizeSolver::layoutLength() const
+{
+    return m_layoutLength;
+}
+
+void IconSizeSolver::setLayoutLength(qreal length)
+{
+    if (qFuzzyCompare(m_layoutLength, length)) {
+        return;
+    }
+
+    m_layoutLength = length;
+    update();
+
+    emit layoutLengthChanged();
+}
+
+int IconSizeSolver::maximumLength() const
+{
+    return m_maximumLength;
+}
+
+void IconSizeSolver::setMaximumLength(int length)
+{
+    if (m_maximumLength == length) {
+        return;
+    }
+
+    m_maximumLength = length;
+    update();
+
+    emit maximumLengthChanged();
+}
+
+int IconSizeSolver::maximumSize() const
+{
+    return m_maximumSize;
+}
+
+void IconSizeSolver::setMaximumSize(int size)
+{
+    if (m_maximumSize == size) {
+        return;
+    }
+
+    m_maximumSize = size;
+    update();
+
+    emit maximumSizeChanged();
+}
+
+int IconSizeSolver::minimumSize() const
+{
+    return m_minimumSize;
+}
+
+void IconSizeSolver::setMinimumSize(int size)
+{
+    if (m_minimumSize == size) {
+        return;
+    }
+
+    m_minimumSize = size;
+    update();
+
+    emit minimumSizeChanged();
+}
+
+int IconSizeSolver::step() const
+{
+    return m_step;
+}
+
+void IconSizeSolver::setStep(int step)
+{
+    if (m_step == step) {
+        return;
+    }
+
+    m_step = step;
+    update();
+
+    emit stepChanged();
+}
+
+qreal IconSizeSolver::zoomFactor() const
+{
+    return m_zoomFactor;
+}
+
+void IconSizeSolver::setZoomFactor(qreal factor)
+{
+    if (qFuzzyCompare(m_zoomFactor, factor)) {
+        return;
+    }
+
+    m_zoomFactor = factor;
+    update();
+
+    emit zoomFactorChanged();
+}
+
+int IconSizeSolver::automaticIconSize() const
+{
+    return m_automaticIconSize;
+}
+
+void IconSizeSolver::setAutomaticIconSize(int size)
+{
+    if (m_automaticIconSize == size) {
+        return;
+    }
+
+    m_automaticIconSize = size;
+
+    emit automaticIconSizeChanged();
+}
+
+void IconSizeSolver::update()
+{
+    //the zoomed length changes in every frame of the zoom, it is solved
+    //once with the last length when the zoom ends
+    if (m_enabled && !m_zoomed && !m_solveTimer.isActive()) {
+        m_solveTimer.start();
+    }
+}
+
+/*
+ * The unzoomed layout is as long as layoutLength/iconSize for each pixel of
+ * icon size and the zoom needs zoomFactor*(size+2*iconMargin) more, the
+ * margin doesn't follow the size. The icons shrink when the current size
+ * doesn't fit and they grow only when a larger size leaves free the length
+ * of one and a half zoomed icons.
+ */
+void IconSizeSolver::solve()
+{
+    if (!m_enabled || m_zoomed || (m_iconSize <= 0) || (m_maximumLength <= 0) || (m_layoutLength <= 0)) {
+        return;
+    }
+
+    qreal layoutPerPixel = m_layoutLength / m_iconSize;
+    qreal zoomMargins = 2 * m_zoomFactor * m_iconMargin;
+
+    int shrinkSize = fittingSize(layoutPerPixel + m_zoomFactor, zoomMargins);
+    int growSize = fittingSize(layoutPerPixel + 1.5 * m_zoomFactor, 1.5 * zoomMargins);
+
+    int size = m_iconSize;
+
+    if (m_iconSize > shrinkSize) {
+        size = shrinkSize;
+    } else if (growSize > m_iconSize) {
+        size = growSize;
+    }
+
+    setAutomaticIconSize(size >= m_maximumSize ? -1 : size);
+}
+
+int IconSizeSolver::fittingSize(qreal lengthPerPixel, qreal constantLength) const
+{
+    qreal fitting = (m_maximumLength - constantLength) / lengthPerPixel;
+
+    if (fitting >= m_maximumSize) {
+        return m_maximumSize;
+    }
+
+    //the sizes are steps down from the maximum one
+    int steps = qCeil((m_maximumSize - fitting) / qMax(1, m_step));
+    int size = m_maximumSize - steps * qMax(1, m_step);
+
+    return qMax(size, qMin(m_minimumSize, m_maximumSize));
+}
+
+}
@@ -0,0 +1,138 @@
+#ifndef ICONSIZESOLVER_H
+#define ICONSIZESOLVER_H
+
+#include <QObject>
+#include <QTimer>
+
+namespace NowDock
+{
+
+/*
+ * Finds the largest icon size that lets the applets fit in the maximum
+ * length of the dock together with the zoom. The length of the layout
+ * follows the icon size, so the fitting size is computed directly instead
+ * of trying the sizes one by one. The icons grow again only when the
+ * larger size fits with more free space than it is needed to shrink,
+ * so the size doesn't jump back and forth when tasks open and close.
+ *
+ * The size is solved once for all the changes of an event loop pass.
+ */
+class IconSizeSolver : public QObject {
+    Q_OBJECT
+
+    /**
+     * the solver runs only when it is enabled, e.g. not during animations
+     */
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+
+    /**
+     * the layout is zoomed, e.g. it is hovered, its length is not the length
+     * for the icon size, so it is not solved until the zoom ends
+     */
+    Q_PROPERTY(bool zoomed READ zoomed WRITE setZoomed NOTIFY zoomedChanged)
+
+    /**
+     * the size that is used now and the unzoomed length of the layout for it
+     */
+    Q_PROPERTY(int iconSize READ iconSize WRITE setIconSize NOTIFY iconSizeChanged)
+    Q_PROPERTY(qreal iconMargin READ iconMargin WRITE setIconMargin NOTIFY iconMarginChanged)
+    Q_PROPERTY(qreal layoutLength READ layoutLength WRITE setLayoutLength NOTIFY layoutLengthChanged)
+
+    Q_PROPERTY(int maximumLength READ maximumLength WRITE setMaximumLength NOTIFY maximumLengthChanged)
+
+    /**
+     * the sizes are maximumSize, maximumSize-step, ... and never smaller than minimumSize
+     */
+    Q_PROPERTY(int maximumSize READ maximumSize WRITE setMaximumSize NOTIFY maximumSizeChanged)
+    Q_PROPERTY(int minimumSize READ minimumSize WRITE setMinimumSize NOTIFY minimumSizeChanged)
+    Q_PROPERTY(int step READ step WRITE setStep NOTIFY stepChanged)
+
+    Q_PROPERTY(qreal zoomFactor READ zoomFactor WRITE setZoomFactor NOTIFY zoomFactorChanged)
+
+    /**
+     * the solved size, -1 when the maximum size fits
+     */
+    Q_PROPERTY(int automaticIconSize READ automaticIconSize NOTIFY automaticIconSizeChanged)
+
+public:
+    explicit IconSizeSolver(QObject *parent = Q_NULLPTR);
+    ~IconSizeSolver();
+
+    bool enabled() const;
+    void setEnabled(bool enabled);
+
+    bool zoomed() const;
+    void setZoomed(bool zoomed);
+
+    int iconSize() const;
+    void setIconSize(int size);
+
+    qreal iconMargin() const;
+    void setIconMargin(qreal margin);
+
+    qreal layoutLength() const;
+    void setLayoutLength(qreal length);
+
+    int maximumLength() const;
+    void setMaximumLength(int length);
+
+    int maximumSize() const;
+    void setMaximumSize(int size);
+
+    int minimumSize() const;
+    void setMinimumSize(int size);
+
+    int step() const;
+    void setStep(int step);
+
+    qreal zoomFactor() const;
+    void setZoomFactor(qreal factor);
+
+    int automaticIconSize() const;
+
+Q_SIGNALS:
+    void automaticIconSizeChanged();
+    void enabledChanged();
+    void iconMarginChanged();
+    void iconSizeChanged();
+    void layoutLengthChanged();
+    void maximumLengthChanged();
+    void maximumSizeChanged();
+    void minimumSizeChanged();
+    void stepChanged();
+    void zoomFactorChanged();
+    void zoomedChanged();
+
+public slots:
+    //requests a new solution for the next event loop pass
+    Q_INVOKABLE void update();
+
+private Q_SLOTS:
+    void solve();
+
+private:
+    bool m_enabled;
+    bool m_zoomed;
+
+    int m_automaticIconSize;
+    int m_iconSize;
+    int m_maximumLength;
+    int m_maximumSize;
+    int m_minimumSize;
+    int m_step;
+
+    qreal m_iconMargin;
+    qreal m_layoutLength;
+    qreal m_zoomFactor;
+
+    QTimer m_solveTimer;
+
+    //the largest size whose length for each pixel of icon size, together
+    //with the constant length, fits
+    int fittingSize(qreal lengthPerPixel, qreal constantLength) const;
+    void setAutomaticIconSize(int size);
+};
+
+}
+
+#endif
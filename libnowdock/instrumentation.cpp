@@ -0,0 +1,291 @@
+#include "instrumentation.h"
+
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QVariantMap>
+
+#include <chrono>
+
+namespace NowDock
+{
+
+static const char *const ProbeNames[Instrumentation::ProbeCount] = {
+    "PanelWindow::updateState",
+    "PanelWindow::applyMaskArea",
+    "PanelWindow::setMaskArea",
+    "XWindowInterface::activeIsMaximized",
+    "XWindowInterface::desktopIsActive",
+    "XWindowInterface::dockIntersectsActiveWindow",
+    "XWindowInterface::dockIsCovered",
+    "XWindowInterface::dockIsCovering",
+    "ZoomEngine::hover",
+    "ZoomEngine::zoom",
+    "PanelWindow::updateHovered",
+    "LayoutManager::beginRestore",
+    "LayoutManager::restore containers",
+    "LayoutManager::restore layout",
+    "LayoutManager::restore locks",
+    "LayoutManager::restore split"
+};
+
+namespace
+{
+
+//written only from the thread that owns it, relaxed atomics let
+//the results be read from any thread
+struct ProbeData {
+    std::atomic<quint64> count;
+    std::atomic<quint64> nsecs;
+    std::atomic<quint64> histogram[Instrumentation::BucketCount];
+};
+
+struct ProbeTotals {
+    quint64 count;
+    quint64 nsecs;
+    quint64 histogram[Instrumentation::BucketCount];
+};
+
+struct ThreadBuffer {
+    ThreadBuffer();
+    ~ThreadBuffer();
+
+    ProbeData probes[Instrumentation::ProbeCount];
+};
+
+struct Registry {
+    QMutex mutex;
+    QList<ThreadBuffer *> buffers;
+    //the results of the threads that have finished
+    ProbeTotals retired[Instrumentation::ProbeCount];
+};
+
+Registry *registry()
+{
+    static Registry instance;
+    return &instance;
+}
+
+ThreadBuffer &threadBuffer()
+{
+    thread_local ThreadBuffer buffer;
+    return buffer;
+}
+
+void increase(std::atomic<quint64> &value, quint64 step)
+{
+    value.store(value.load(std::memory_order_relaxed) + step, std::memory_order_relaxed);
+}
+
+void addTo(ProbeTotals *totals, const ProbeData &data)
+{
+    totals->count += data.count.load(std::memory_order_relaxed);
+    totals->nsecs += data.nsecs.load(std::memory_order_relaxed);
+
+    for (int i=0; i<Instrumentation::BucketCount; ++i) {
+        totals->histogram[i] += data.histogram[i].load(std::memory_order_relaxed);
+    }
+}
+
+int bucket(qint64 nsecs)
+{
+    qint64 usecs = nsecs / 1000;
+    int result = 0;
+
+    while (usecs > 0 && result < Instrumentation::BucketCount - 1) {
+        usecs >>= 1;
+        ++result;
+    }
+
+    return result;
+}
+
+//all the threads together
+void collect(ProbeTotals *totals)
+{
+    Registry *r = registry();
+    QMutexLocker locker(&r->mutex);
+
+    for (int p=0; p<Instrumentation::ProbeCount; ++p) {
+        totals[p] = r->retired[p];
+
+        foreach (ThreadBuffer *buffer, r->buffers) {
+            addTo(&totals[p], buffer->probes[p]);
+        }
+    }
+}
+
+ThreadBuffer::ThreadBuffer() :
+    probes()
+{
+    Registry *r = registry();
+    QMutexLocker locker(&r->mutex);
+
+    r->buffers.append(this);
+}
+
+ThreadBuffer::~ThreadBuffer()
+{
+    Registry *r = registry();
+    QMutexLocker locker(&r->mutex);
+
+    for (int p=0; p<Instrumentation::ProbeCount; ++p) {
+        addTo(&r->retired[p], probes[p]);
+    }
+
+    r->buffers.removeAll(this);
+}
+
+}
+
+std::atomic<bool> Instrumentation::s_enabled(qEnvironmentVariableIsSet("NOWDOCK_INSTRUMENTATION"));
+
+Instrumentation::Instrumentation(QObject *parent) :
+    QObject(parent)
+{
+}
+
+Instrumentation::~Instrumentation()
+{
+}
+
+bool Instrumentation::enabled() const
+{
+    return isEnabled();
+}
+
+void Instrumentation::setEnabled(bool enabled)
+{
+    if (isEnabled() == enabled) {
+        return;
+    }
+
+    s_enabled.store(enabled, std::memory_order_relaxed);
+
+    emit enabledChanged();
+}
+
+qint64 Instrumentation::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Instrumentation::record(Probe probe, qint64 nsecs)
+{
+    if (probe < 0 || probe >= ProbeCount) {
+        return;
+    }
+
+    ProbeData &data = threadBuffer().probes[probe];
+
+    increase(data.count, 1);
+    increase(data.nsecs, nsecs);
+    increase(data.histogram[bucket(nsecs)], 1);
+}
+
+QString Instrumentation::report()
+{
+    ProbeTotals totals[ProbeCount];
+    collect(totals);
+
+    QString result;
+    QTextStream stream(&result);
+
+    for (int p=0; p<ProbeCount; ++p) {
+        const ProbeTotals &probe = totals[p];
+
+        if (probe.count == 0) {
+            continue;
+        }
+
+        stream << ProbeNames[p] << " count: " << probe.count
+               << " total: " << (probe.nsecs / 1000) << "us"
+               << " mean: " << (probe.nsecs / probe.count / 1000.0) << "us"
+               << " histogram:";
+
+        for (int i=0; i<BucketCount; ++i) {
+            stream << " " << probe.histogram[i];
+        }
+
+        stream << "\n";
+    }
+
+    return result;
+}
+
+QVariantList Instrumentation::counters() const
+{
+    ProbeTotals totals[ProbeCount];
+    collect(totals);
+
+    QVariantList result;
+
+    for (int p=0; p<ProbeCount; ++p) {
+        const ProbeTotals &probe = totals[p];
+
+        QVariantList histogram;
+
+        for (int i=0; i<BucketCount; ++i) {
+            histogram.append(probe.histogram[i]);
+        }
+
+        QVariantMap map;
+        map.insert(QStringLiteral("name"), QString::fromLatin1(ProbeNames[p]));
+        map.insert(QStringLiteral("count"), probe.count);
+        map.insert(QStringLiteral("totalUs"), probe.nsecs / 1000);
+        map.insert(QStringLiteral("meanUs"), probe.count ? (probe.nsecs / probe.count / 1000.0) : 0.0);
+        map.insert(QStringLiteral("histogram"), histogram);
+
+        result.append(map);
+    }
+
+    return result;
+}
+
+bool Instrumentation::dump(const QString &fileName) const
+{
+    QString text = report();
+
+    if (fileName.isEmpty()) {
+        QTextStream out(stdout);
+        out << text;
+        return true;
+    }
+
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << text;
+
+    return true;
+}
+
+void Instrumentation::reset()
+{
+    Registry *r = registry();
+    QMutexLocker locker(&r->mutex);
+
+    for (int p=0; p<ProbeCount; ++p) {
+        r->retired[p] = ProbeTotals();
+
+        foreach (ThreadBuffer *buffer, r->buffers) {
+            ProbeData &data = buffer->probes[p];
+
+            data.count.store(0, std::memory_order_relaxed);
+            data.nsecs.store(0, std::memory_order_relaxed);
+
+            for (int i=0; i<BucketCount; ++i) {
+                data.histogram[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,111 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <QObject>
+#include <QVariantList>
+
+#include <atomic>
+
+namespace NowDock
+{
+
+/*
+ * Counters and latency histograms for the hot paths of the dock. Every
+ * thread records in its own buffer, the buffers are summed only when the
+ * results are read. When it is disabled a probe costs a relaxed atomic
+ * read. It is enabled from QML or with the NOWDOCK_INSTRUMENTATION
+ * environment variable and all the instances share the same results.
+ *
+ *     Instrumentation::Scope scope(Instrumentation::UpdateState);
+ */
+class Instrumentation : public QObject {
+    Q_OBJECT
+
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+
+public:
+    enum Probe {
+        UpdateState = 0,
+        ApplyMaskArea,
+        SetMaskArea,
+        ActiveIsMaximized,
+        DesktopIsActive,
+        DockIntersectsActiveWindow,
+        DockIsCovered,
+        DockIsCovering,
+        ZoomHover,
+        Zoom,
+        UpdateHovered,
+        RestoreOrder,
+        RestoreContainers,
+        RestoreLayout,
+        RestoreLocks,
+        RestoreSplit,
+        ProbeCount
+    };
+
+    //the buckets are powers of two in microseconds, <1us, <2us, <4us, ... and the last one is open
+    static const int BucketCount = 16;
+
+    //measures the probe from its construction until it is destroyed
+    class Scope {
+    public:
+        explicit Scope(Probe probe) :
+            m_probe(probe),
+            m_start(isEnabled() ? now() : -1)
+        {
+        }
+
+        ~Scope()
+        {
+            if (m_start >= 0) {
+                record(m_probe, now() - m_start);
+            }
+        }
+
+    private:
+        Probe m_probe;
+        qint64 m_start;
+
+        Q_DISABLE_COPY(Scope)
+    };
+
+    explicit Instrumentation(QObject *parent = Q_NULLPTR);
+    ~Instrumentation();
+
+    bool enabled() const;
+    void setEnabled(bool enabled);
+
+    static bool isEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    static void record(Probe probe, qint64 nsecs);
+    //monotonic time in ns
+    static qint64 now();
+
+    //a line for every probe that has been recorded
+    static QString report();
+
+Q_SIGNALS:
+    void enabledChanged();
+
+public slots:
+    /*
+     * a map for every probe with: name, count, totalUs, meanUs and
+     * histogram, the counts of the buckets
+     */
+    Q_INVOKABLE QVariantList counters() const;
+    //writes the report to the file or to stdout when there isn't any
+    Q_INVOKABLE bool dump(const QString &fileName = QString()) const;
+    //samples that are recorded at the same time may be lost
+    Q_INVOKABLE void reset();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+}
+
+#endif
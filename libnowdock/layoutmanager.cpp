@@ -0,0 +1,521 @@
+#include "layoutmanager.h"
+
+#include "instrumentation.h"
+
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+
+namespace NowDock
+{
+
+LayoutManager::LayoutManager(QObject *parent) :
+    QObject(parent),
+    m_horizontal(true),
+    m_splitterEnabled(false),
+    m_splitterPosition(-1),
+    m_restoreStart(-1)
+{
+    //all the changes of an event loop pass are saved together
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(0);
+    connect(&m_saveTimer, &QTimer::timeout, this, &LayoutManager::saveOrder);
+}
+
+LayoutManager::~LayoutManager()
+{
+}
+
+bool LayoutManager::horizontal() const
+{
+    return m_horizontal;
+}
+
+void LayoutManager::setHorizontal(bool horizontal)
+{
+    if (m_horizontal == horizontal) {
+        return;
+    }
+
+    m_horizontal = horizontal;
+
+    emit horizontalChanged();
+}
+
+bool LayoutManager::splitterEnabled() const
+{
+    return m_splitterEnabled;
+}
+
+void LayoutManager::setSplitterEnabled(bool enabled)
+{
+    if (m_splitterEnabled == enabled) {
+        return;
+    }
+
+    m_splitterEnabled = enabled;
+
+    emit splitterEnabledChanged();
+}
+
+int LayoutManager::splitterPosition() const
+{
+    return m_splitterPosition;
+}
+
+void LayoutManager::setSplitterPosition(int position)
+{
+    if (m_splitterPosition == position) {
+        return;
+    }
+
+    m_splitterPosition = position;
+
+    emit splitterPositionChanged();
+}
+
+QString LayoutManager::appletOrder() const
+{
+    return m_appletOrder;
+}
+
+void LayoutManager::setAppletOrder(const QString &order)
+{
+    if (m_appletOrder == order) {
+        return;
+    }
+
+    m_appletOrder = order;
+
+    emit appletOrderChanged();
+}
+
+QString LayoutManager::lockedZoomApplets() const
+{
+    return m_lockedZoomApplets;
+}
+
+void LayoutManager::setLockedZoomApplets(const QString &applets)
+{
+    if (m_lockedZoomApplets == applets) {
+        return;
+    }
+
+    m_lockedZoomApplets = applets;
+
+    emit lockedZoomAppletsChanged();
+}
+
+QQuickItem *LayoutManager::root() const
+{
+    return m_root;
+}
+
+void LayoutManager::setRoot(QQuickItem *root)
+{
+    if (m_root == root) {
+        return;
+    }
+
+    m_root = root;
+
+    emit rootChanged();
+}
+
+QQuickItem *LayoutManager::mainLayout() const
+{
+    return m_mainLayout;
+}
+
+void LayoutManager::setMainLayout(QQuickItem *layout)
+{
+    if (m_mainLayout == layout) {
+        return;
+    }
+
+    m_mainLayout = layout;
+
+    emit mainLayoutChanged();
+}
+
+QQuickItem *LayoutManager::secondLayout() const
+{
+    return m_secondLayout;
+}
+
+void LayoutManager::setSecondLayout(QQuickItem *layout)
+{
+    if (m_secondLayout == layout) {
+        return;
+    }
+
+    m_secondLayout = layout;
+
+    emit secondLayoutChanged();
+}
+
+QQuickItem *LayoutManager::lastSpacer() const
+{
+    return m_lastSpacer;
+}
+
+void LayoutManager::setLastSpacer(QQuickItem *spacer)
+{
+    if (m_lastSpacer == spacer) {
+        return;
+    }
+
+    m_lastSpacer = spacer;
+
+    emit lastSpacerChanged();
+}
+
+bool LayoutManager::isLayout(QQuickItem *item) const
+{
+    return item && ((item == m_mainLayout) || (item == m_secondLayout));
+}
+
+QList<QQuickItem *> LayoutManager::items() const
+{
+    QList<QQuickItem *> result;
+
+    if (m_mainLayout) {
+        result = m_mainLayout->childItems();
+    }
+
+    if (m_secondLayout) {
+        result += m_secondLayout->childItems();
+    }
+
+    return result;
+}
+
+//insert item before the before item
+int LayoutManager::insertBefore(QQuickItem *before, QQuickItem *item)
+{
+    if (!before || !item || (before == item)) {
+        return -1;
+    }
+
+    QQuickItem *layout = isLayout(before->parentItem()) ? before->parentItem() : m_mainLayout.data();
+
+    if (!layout) {
+        return -1;
+    }
+
+    if (item->parentItem() != layout) {
+        item->setParentItem(layout);
+    }
+
+    if (before->parentItem() == layout) {
+        item->stackBefore(before);
+    }
+
+    return layout->childItems().indexOf(item);
+}
+
+//insert item after the after item
+int LayoutManager::insertAfter(QQuickItem *after, QQuickItem *item)
+{
+    if (!after || !item || (after == item)) {
+        return -1;
+    }
+
+    QQuickItem *layout = isLayout(after->parentItem()) ? after->parentItem() : m_mainLayout.data();
+
+    if (!layout) {
+        return -1;
+    }
+
+    if (item->parentItem() != layout) {
+        item->setParentItem(layout);
+    }
+
+    if (after->parentItem() == layout) {
+        //never ever insert after lastSpacer
+        if (after == m_lastSpacer) {
+            item->stackBefore(after);
+        } else {
+            item->stackAfter(after);
+        }
+    }
+
+    return layout->childItems().indexOf(item);
+}
+
+void LayoutManager::insertAtIndex(QQuickItem *item, int position)
+{
+    if (!item || !m_mainLayout) {
+        return;
+    }
+
+    QList<QQuickItem *> children = m_mainLayout->childItems();
+
+    if ((position < 0) || ((position >= children.count()) && (position != 0))) {
+        return;
+    }
+
+    //Important !!! , this is used to add the first item
+    if ((children.count() == 1) && (children.first() == m_lastSpacer)) {
+        m_lastSpacer->setParentItem(m_root);
+        children.clear();
+        position = 0;
+    }
+
+    //never ever insert after lastSpacer
+    if ((position < children.count()) && (children.at(position) == m_lastSpacer)) {
+        position = qMax(0, position - 1);
+    }
+
+    QQuickItem *before = (position < children.count()) ? children.at(position) : 0;
+
+    if (item->parentItem() != m_mainLayout) {
+        item->setParentItem(m_mainLayout);
+    }
+
+    if (before && (before != item)) {
+        item->stackBefore(before);
+    }
+}
+
+int LayoutManager::insertAtCoordinates(QQuickItem *item, qreal x, qreal y)
+{
+    if (!item || !m_mainLayout) {
+        return -1;
+    }
+
+    if (m_horizontal) {
+        y = m_mainLayout->height() / 2;
+    } else {
+        x = m_mainLayout->width() / 2;
+    }
+
+    QList<QQuickItem *> children = m_mainLayout->childItems();
+    QQuickItem *child = m_mainLayout->childAt(x, y);
+
+    //if we got a place inside the space between 2 applets, we have to find it manually
+    if (!child) {
+        qreal spacing = m_mainLayout->property(m_horizontal ? "rowSpacing" : "columnSpacing").toReal();
+
+        foreach (QQuickItem *candidate, children) {
+            if (m_horizontal && (x >= candidate->x()) && (x < candidate->x() + candidate->width() + spacing)) {
+                child = candidate;
+                break;
+            } else if (!m_horizontal && (y >= candidate->y()) && (y < candidate->y() + candidate->height() + spacing)) {
+                child = candidate;
+                break;
+            }
+        }
+    }
+
+    //already in position
+    if (child == item) {
+        return children.indexOf(item);
+    }
+
+    if (!child) {
+        if (children.isEmpty()) {
+            item->setParentItem(m_mainLayout);
+            return 0;
+        }
+
+        child = children.first();
+    }
+
+    if ((!m_horizontal && (y < child->y() + child->height() / 2)) ||
+            (m_horizontal && (x < child->x() + child->width() / 2))) {
+        return insertBefore(child, item);
+    } else {
+        return insertAfter(child, item);
+    }
+}
+
+QVariantList LayoutManager::orderedApplets(const QVariantList &applets) const
+{
+    //map applet id->order in panel
+    QHash<QString, int> idsOrder;
+    QStringList ids = m_appletOrder.split(QLatin1Char(';'));
+
+    for (int i=0; i<ids.count(); ++i) {
+        idsOrder.insert(ids.at(i), i);
+    }
+
+    //map order in panel -> applet
+    QMap<int, QVariant> appletsOrder;
+    //ones that weren't saved in the order go to the end
+    QVariantList unordered;
+
+    foreach (const QVariant &applet, applets) {
+        QObject *object = applet.value<QObject *>();
+
+        if (!object) {
+            continue;
+        }
+
+        QHash<QString, int>::const_iterator it = idsOrder.constFind(object->property("id").toString());
+
+        if (it != idsOrder.constEnd()) {
+            appletsOrder.insert(it.value(), applet);
+        } else {
+            unordered.append(applet);
+        }
+    }
+
+    return appletsOrder.values() + unordered;
+}
+
+QVariantList LayoutManager::beginRestore(const QVariantList &applets)
+{
+    Instrumentation::Scope scope(Instrumentation::RestoreOrder);
+
+    QVariantList ordered = orderedApplets(applets);
+
+    //the containers are created from QML until restore is called
+    m_restoreStart = Instrumentation::isEnabled() ? Instrumentation::now() : -1;
+
+    return ordered;
+}
+
+void LayoutManager::restore(const QVariantList &containers, bool split)
+{
+    if (!m_mainLayout) {
+        return;
+    }
+
+    if (m_restoreStart >= 0) {
+        Instrumentation::record(Instrumentation::RestoreContainers, Instrumentation::now() - m_restoreStart);
+        m_restoreStart = -1;
+    }
+
+    {
+        Instrumentation::Scope scope(Instrumentation::RestoreLayout);
+
+        //the containers are added after anything that is already in the layout,
+        //the spacer is not needed when there are applets
+        if (!containers.isEmpty() && m_lastSpacer && (m_lastSpacer->parentItem() == m_mainLayout)) {
+            m_lastSpacer->setParentItem(m_root);
+        }
+
+        foreach (const QVariant &container, containers) {
+            QQuickItem *item = container.value<QQuickItem *>();
+
+            if (item) {
+                item->setParentItem(m_mainLayout);
+            }
+        }
+    }
+
+    {
+        Instrumentation::Scope scope(Instrumentation::RestoreLocks);
+
+        restoreLocks();
+    }
+
+    Instrumentation::Scope scope(Instrumentation::RestoreSplit);
+
+    splitLayouts(split);
+
+    //rewrite, so if in the orders there were now invalid ids or if some were missing creates a correct list instead
+    save();
+}
+
+void LayoutManager::removeApplet(QObject *applet)
+{
+    if (!applet) {
+        return;
+    }
+
+    foreach (QQuickItem *child, items()) {
+        if (child->property("applet").value<QObject *>() == applet) {
+            child->deleteLater();
+        }
+    }
+}
+
+void LayoutManager::restoreLocks()
+{
+    QSet<QString> ids = m_lockedZoomApplets.split(QLatin1Char(';')).toSet();
+
+    foreach (QQuickItem *child, items()) {
+        QObject *applet = child->property("applet").value<QObject *>();
+
+        if (applet && ids.contains(applet->property("id").toString())) {
+            child->setProperty("lockZoom", true);
+        }
+    }
+}
+
+void LayoutManager::save()
+{
+    if (!m_saveTimer.isActive()) {
+        m_saveTimer.start();
+    }
+}
+
+void LayoutManager::saveOrder()
+{
+    QStringList ids;
+    int splitter = -1;
+
+    QList<QQuickItem *> children = items();
+
+    for (int i=0; i<children.count(); ++i) {
+        QObject *applet = children.at(i)->property("applet").value<QObject *>();
+
+        if (applet) {
+            ids.append(applet->property("id").toString());
+        } else if (m_splitterEnabled && children.at(i)->property("isInternalViewSplitter").toBool()) {
+            splitter = i;
+        }
+    }
+
+    setSplitterPosition(splitter);
+    setAppletOrder(ids.join(QLatin1Char(';')));
+}
+
+void LayoutManager::saveLocks()
+{
+    QStringList ids;
+
+    foreach (QQuickItem *child, items()) {
+        QObject *applet = child->property("applet").value<QObject *>();
+
+        if (applet && child->property("lockZoom").toBool()) {
+            ids.append(applet->property("id").toString());
+        }
+    }
+
+    setLockedZoomApplets(ids.join(QLatin1Char(';')));
+}
+
+void LayoutManager::splitLayouts(bool split)
+{
+    if (!m_mainLayout || !m_secondLayout) {
+        return;
+    }
+
+    if (split) {
+        bool afterSplitter = false;
+
+        foreach (QQuickItem *child, m_mainLayout->childItems()) {
+            if (afterSplitter) {
+                child->setParentItem(m_secondLayout);
+            } else if (child->property("isInternalViewSplitter").toBool()) {
+                afterSplitter = true;
+            }
+        }
+    } else {
+        bool beforeSpacer = m_lastSpacer && (m_lastSpacer->parentItem() == m_mainLayout);
+
+        foreach (QQuickItem *child, m_secondLayout->childItems()) {
+            child->setParentItem(m_mainLayout);
+
+            if (beforeSpacer) {
+                child->stackBefore(m_lastSpacer);
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,154 @@
+#ifndef LAYOUTMANAGER_H
+#define LAYOUTMANAGER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QQuickItem>
+#include <QTimer>
+#include <QVariantList>
+
+namespace NowDock
+{
+
+/*
+ * Keeps the order of the applet containers of the dock. The order is the
+ * children order of the main layout, followed by the second layout when the
+ * applets after the splitter have been moved there. An item is moved with
+ * a single restacking in its layout, instead of reparenting all the items
+ * after it, so the layout is positioned only once for every batch of
+ * changes. The order, the splitter position and the locked applets are
+ * written to their properties at most once per event loop pass.
+ */
+class LayoutManager : public QObject {
+    Q_OBJECT
+
+    Q_PROPERTY(bool horizontal READ horizontal WRITE setHorizontal NOTIFY horizontalChanged)
+
+    /**
+     * the splitter position is saved only when it is used, e.g. in the double layout
+     */
+    Q_PROPERTY(bool splitterEnabled READ splitterEnabled WRITE setSplitterEnabled NOTIFY splitterEnabledChanged)
+
+    Q_PROPERTY(int splitterPosition READ splitterPosition WRITE setSplitterPosition NOTIFY splitterPositionChanged)
+
+    /**
+     * the applet ids in their order, separated with ";"
+     */
+    Q_PROPERTY(QString appletOrder READ appletOrder WRITE setAppletOrder NOTIFY appletOrderChanged)
+
+    /**
+     * the ids of the applets whose zoom is locked, separated with ";"
+     */
+    Q_PROPERTY(QString lockedZoomApplets READ lockedZoomApplets WRITE setLockedZoomApplets NOTIFY lockedZoomAppletsChanged)
+
+    /**
+     * the items are parked here while they are out of the layouts
+     */
+    Q_PROPERTY(QQuickItem *root READ root WRITE setRoot NOTIFY rootChanged)
+
+    Q_PROPERTY(QQuickItem *mainLayout READ mainLayout WRITE setMainLayout NOTIFY mainLayoutChanged)
+
+    Q_PROPERTY(QQuickItem *secondLayout READ secondLayout WRITE setSecondLayout NOTIFY secondLayoutChanged)
+
+    /**
+     * the spacer that fills the main layout, nothing is placed after it
+     */
+    Q_PROPERTY(QQuickItem *lastSpacer READ lastSpacer WRITE setLastSpacer NOTIFY lastSpacerChanged)
+
+public:
+    explicit LayoutManager(QObject *parent = Q_NULLPTR);
+    ~LayoutManager();
+
+    bool horizontal() const;
+    void setHorizontal(bool horizontal);
+
+    bool splitterEnabled() const;
+    void setSplitterEnabled(bool enabled);
+
+    int splitterPosition() const;
+    void setSplitterPosition(int position);
+
+    QString appletOrder() const;
+    void setAppletOrder(const QString &order);
+
+    QString lockedZoomApplets() const;
+    void setLockedZoomApplets(const QString &applets);
+
+    QQuickItem *root() const;
+    void setRoot(QQuickItem *root);
+
+    QQuickItem *mainLayout() const;
+    void setMainLayout(QQuickItem *layout);
+
+    QQuickItem *secondLayout() const;
+    void setSecondLayout(QQuickItem *layout);
+
+    QQuickItem *lastSpacer() const;
+    void setLastSpacer(QQuickItem *spacer);
+
+Q_SIGNALS:
+    void appletOrderChanged();
+    void horizontalChanged();
+    void lastSpacerChanged();
+    void lockedZoomAppletsChanged();
+    void mainLayoutChanged();
+    void rootChanged();
+    void secondLayoutChanged();
+    void splitterEnabledChanged();
+    void splitterPositionChanged();
+
+public slots:
+    /*
+     * Bulk loading of the applets at startup, beginRestore returns the applets
+     * in their saved order and restore places all of their containers, in the
+     * same order, and the splitter in the layouts at once. The time of each
+     * step is recorded in the Restore probes of Instrumentation.
+     */
+    Q_INVOKABLE QVariantList beginRestore(const QVariantList &applets);
+    //split: the items after the splitter are moved to the second layout
+    Q_INVOKABLE void restore(const QVariantList &containers, bool split);
+
+    //returns the index of the item in its layout
+    Q_INVOKABLE int insertAfter(QQuickItem *after, QQuickItem *item);
+    Q_INVOKABLE int insertAtCoordinates(QQuickItem *item, qreal x, qreal y);
+    Q_INVOKABLE void insertAtIndex(QQuickItem *item, int position);
+    Q_INVOKABLE int insertBefore(QQuickItem *before, QQuickItem *item);
+    //the applets sorted by the saved order, the unknown ones are placed at the end
+    Q_INVOKABLE QVariantList orderedApplets(const QVariantList &applets) const;
+    Q_INVOKABLE void removeApplet(QObject *applet);
+    Q_INVOKABLE void restoreLocks();
+    Q_INVOKABLE void save();
+    Q_INVOKABLE void saveLocks();
+    //moves the items after the splitter to the second layout or all of them back
+    Q_INVOKABLE void splitLayouts(bool split);
+
+private Q_SLOTS:
+    void saveOrder();
+
+private:
+    bool m_horizontal;
+    bool m_splitterEnabled;
+
+    int m_splitterPosition;
+
+    QString m_appletOrder;
+    QString m_lockedZoomApplets;
+
+    QPointer<QQuickItem> m_root;
+    QPointer<QQuickItem> m_mainLayout;
+    QPointer<QQuickItem> m_secondLayout;
+    QPointer<QQuickItem> m_lastSpacer;
+
+    QTimer m_saveTimer;
+
+    //when beginRestore has finished, -1 if the restore is not measured
+    qint64 m_restoreStart;
+
+    bool isLayout(QQuickItem *item) const;
+    //the applet containers of both layouts in their order
+    QList<QQuickItem *> items() const;
+};
+
+}
+
+#endif
@@ -1,6 +1,10 @@
 #include "nowdockplugin.h"
+#include "iconsizesolver.h"
+#include "instrumentation.h"
+#include "layoutmanager.h"
 #include "panelwindow.h"
 #include "windowsystem.h"
+#include "zoomengine.h"
 //#include "types.h"
 
 #include <qqml.h>
@@ -11,7 +15,11 @@ void NowDockPlugin::registerTypes(const char *uri)
 
   //  qmlRegisterUncreatableType<NowDock::Types>(uri, 0, 1, "Types", "");
 
+    qmlRegisterType<NowDock::IconSizeSolver>(uri, 0, 1, "IconSizeSolver");
+    qmlRegisterType<NowDock::Instrumentation>(uri, 0, 1, "Instrumentation");
+    qmlRegisterType<NowDock::LayoutManager>(uri, 0, 1, "LayoutManager");
     qmlRegisterType<NowDock::PanelWindow>(uri, 0, 1, "PanelWindow");
     qmlRegisterType<NowDock::WindowSystem>(uri, 0, 1, "WindowSystem");
+    qmlRegisterType<NowDock::ZoomEngine>(uri, 0, 1, "ZoomEngine");
 }
 
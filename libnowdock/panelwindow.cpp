@@ -1,5 +1,6 @@
 #include "panelwindow.h"
 
+#include "instrumentation.h"
 #include "xwindowinterface.h"
 
 #include <QMenu>
@@ -15,6 +16,7 @@
 #include <KAuthorized>
 #include <KLocalizedString>
 #include <KPluginInfo>
+#include <KWindowSystem>
 
 #include <Plasma/Applet>
 #include <Plasma/Containment>
@@ -27,35 +29,86 @@ namespace NowDock
 
 PanelWindow::PanelWindow(QQuickWindow *parent) :
     QQuickWindow(parent),
-    m_immutable(true),
+    m_appletTrackingDirty(false),
+    m_contentsAnimated(false),
+    m_contentsHovered(false),
     m_disableHiding(false),
+    m_immutable(true),
+    m_inputMaskOnly(false),
     m_isAutoHidden(false),
     m_isHovered(false),
+    m_lengthAnimated(false),
+    m_maskDirty(false),
+    m_normalState(false),
     m_secondInitPass(false),
+    m_thicknessAnimated(false),
     m_windowIsInAttention(false),
+    m_alignment(Center),
     m_childrenLength(-1),
-    m_tempThickness(-1)
+    m_contentsLength(0),
+    m_hoverContentsLength(0),
+    m_edgeSpacing(0),
+    m_hideDelay(1500),
+    m_hoveredIndex(-1),
+    m_tempThickness(-1),
+    m_maskThicknessAutoHidden(0),
+    m_maskThicknessMid(0),
+    m_maskThicknessNormal(0),
+    m_maskThicknessZoom(0),
+    m_hoveredOffset(0),
+    m_zoomLengthIncrease(-1),
+    m_visibilityState(Raised),
+    m_interface(0)
 {    
+    //the whole window is cleared and rendered on every frame, the scene graph
+    //owns the buffer swap and disables the scissor test before it renders, so
+    //a damaged region can't be repainted alone or reported to the compositor
     setClearBeforeRendering(true);
     setColor(QColor(Qt::transparent));
     setFlags(Qt::Tool|Qt::FramelessWindowHint|Qt::WindowDoesNotAcceptFocus);
 
-    m_interface = new XWindowInterface(this);
-    connect(m_interface, SIGNAL(windowInAttention(bool)), this, SLOT(setWindowInAttention(bool)));
-    //connect(m_interface, SIGNAL(windowChanged()), this, SLOT(windowChanged()));
-    connect(m_interface, SIGNAL(activeWindowChanged()), this, SLOT(activeWindowChanged()));
-    m_interface->setDockToAllDesktops();
-
     m_screen = screen();
     connect(this, SIGNAL(screenChanged(QScreen *)), this, SLOT(screenChanged(QScreen *)));
     if (m_screen) {
         connect(m_screen, SIGNAL(geometryChanged(const QRect &)), this, SIGNAL(screenGeometryChanged()));
     }
 
+    //the state is evaluated only when something has changed, the timer
+    //just merges the changes that arrive in the same event loop pass
     m_updateStateTimer.setSingleShot(true);
-    m_updateStateTimer.setInterval(1500);
+    m_updateStateTimer.setInterval(0);
     connect(&m_updateStateTimer, &QTimer::timeout, this, &PanelWindow::updateState);
 
+    //the grace period after the mouse has left the dock, the dock
+    //is not lowered while it is active
+    m_hideTimer.setSingleShot(true);
+    m_hideTimer.setInterval(m_hideDelay);
+    connect(&m_hideTimer, &QTimer::timeout, this, &PanelWindow::updateState);
+
+    //the applet index reads the geometries of the applets, it is rebuilt
+    //only when applets are shown, hidden or reparented
+    m_appletIndexTimer.setSingleShot(true);
+    m_appletIndexTimer.setInterval(0);
+    connect(&m_appletIndexTimer, &QTimer::timeout, this, &PanelWindow::rebuildAppletIndex);
+
+    //and sorted again when the applets have stopped moving, their order
+    //doesn't change during the animations
+    m_appletOrderTimer.setSingleShot(true);
+    m_appletOrderTimer.setInterval(100);
+    connect(&m_appletOrderTimer, &QTimer::timeout, this, &PanelWindow::sortAppletIndex);
+
+    setInterface(new XWindowInterface(this));
+
+    //the mask area is computed once per frame after the animations have advanced
+    connect(this, &QQuickWindow::afterAnimating, this, &PanelWindow::applyMaskArea);
+    connect(KWindowSystem::self(), SIGNAL(compositingChanged(bool)), this, SLOT(updateMaskArea()));
+    connect(this, SIGNAL(widthChanged(int)), this, SLOT(updateMaskArea()));
+    connect(this, SIGNAL(heightChanged(int)), this, SLOT(updateMaskArea()));
+    connect(this, SIGNAL(immutableChanged()), this, SLOT(updateMaskArea()));
+    connect(this, SIGNAL(isAutoHiddenChanged()), this, SLOT(updateMaskArea()));
+    connect(this, SIGNAL(locationChanged()), this, SLOT(updateMaskArea()));
+    connect(this, SIGNAL(panelVisibilityChanged()), this, SLOT(updateMaskArea()));
+
     m_initTimer.setSingleShot(true);
     m_initTimer.setInterval(400);
     connect(&m_initTimer, &QTimer::timeout, this, &PanelWindow::initWindow);
@@ -65,7 +118,14 @@ PanelWindow::PanelWindow(QQuickWindow *parent) :
     updateVisibilityFlags();
 
     connect(this, SIGNAL(locationChanged()), this, SLOT(updateWindowPosition()));
-    connect(this, SIGNAL(windowInAttentionChanged()), this, SLOT(updateState()));
+    connect(this, SIGNAL(screenGeometryChanged()), this, SLOT(updateInterfaceScreen()));
+    connect(this, SIGNAL(windowInAttentionChanged()), this, SLOT(requestUpdateState()));
+    connect(this, SIGNAL(isHoveredChanged()), this, SLOT(requestUpdateState()));
+    connect(this, SIGNAL(disableHidingChanged()), this, SLOT(requestUpdateState()));
+
+    //the QML part requests the sliding animations too, e.g. in the edit mode
+    connect(this, SIGNAL(mustBeRaised()), this, SLOT(raiseRequested()));
+    connect(this, SIGNAL(mustBeLowered()), this, SLOT(lowerRequested()));
 
     initialize();
 }
@@ -73,6 +133,270 @@ PanelWindow::PanelWindow(QQuickWindow *parent) :
 PanelWindow::~PanelWindow()
 {
     qDebug() << "Destroying Now Dock - Magic Window";
+
+    clearContextMenus();
+}
+
+AbstractInterface *PanelWindow::interface() const
+{
+    return m_interface;
+}
+
+void PanelWindow::setInterface(AbstractInterface *interface)
+{
+    if (!interface || m_interface == interface) {
+        return;
+    }
+
+    if (m_interface) {
+        disconnect(m_interface, 0, this, 0);
+
+        if (m_interface->parent() == this) {
+            m_interface->deleteLater();
+        }
+    }
+
+    m_interface = interface;
+
+    connect(m_interface, SIGNAL(windowInAttention(bool)), this, SLOT(setWindowInAttention(bool)));
+    connect(m_interface, SIGNAL(windowChanged()), this, SLOT(activeWindowChanged()));
+    connect(m_interface, SIGNAL(activeWindowChanged()), this, SLOT(activeWindowChanged()));
+    connect(m_interface, SIGNAL(dockStateChanged()), this, SLOT(dockStateChanged()));
+
+    m_interface->setDockToAllDesktops();
+    m_interface->setMaskArea(m_maskArea);
+    m_interface->setScreenGeometry(screenGeometry());
+
+    if (m_inputMaskOnly) {
+        m_interface->setInputMask(m_maskArea);
+    }
+
+    requestUpdateState();
+}
+
+int PanelWindow::alignment() const
+{
+    return m_alignment;
+}
+
+void PanelWindow::setAlignment(int value)
+{
+    if (m_alignment == value) {
+        return;
+    }
+
+    m_alignment = value;
+    emit alignmentChanged();
+
+    updateMaskArea();
+}
+
+bool PanelWindow::contentsAnimated() const
+{
+    return m_contentsAnimated;
+}
+
+void PanelWindow::setContentsAnimated(bool value)
+{
+    if (m_contentsAnimated == value) {
+        return;
+    }
+
+    m_contentsAnimated = value;
+    emit contentsAnimatedChanged();
+
+    updateMaskArea();
+}
+
+bool PanelWindow::contentsHovered() const
+{
+    return m_contentsHovered;
+}
+
+void PanelWindow::setContentsHovered(bool value)
+{
+    if (m_contentsHovered == value) {
+        return;
+    }
+
+    m_contentsHovered = value;
+
+    //the layout has not been zoomed yet
+    if (m_contentsHovered) {
+        m_hoverContentsLength = m_contentsLength;
+    }
+
+    emit contentsHoveredChanged();
+
+    updateMaskArea();
+}
+
+int PanelWindow::contentsLength() const
+{
+    return m_contentsLength;
+}
+
+void PanelWindow::setContentsLength(int value)
+{
+    if (m_contentsLength == value) {
+        return;
+    }
+
+    m_contentsLength = value;
+    emit contentsLengthChanged();
+
+    updateMaskArea();
+}
+
+int PanelWindow::edgeSpacing() const
+{
+    return m_edgeSpacing;
+}
+
+void PanelWindow::setEdgeSpacing(int value)
+{
+    if (m_edgeSpacing == value) {
+        return;
+    }
+
+    m_edgeSpacing = value;
+    emit edgeSpacingChanged();
+
+    updateMaskArea();
+}
+
+bool PanelWindow::lengthAnimated() const
+{
+    return m_lengthAnimated;
+}
+
+void PanelWindow::setLengthAnimated(bool value)
+{
+    if (m_lengthAnimated == value) {
+        return;
+    }
+
+    m_lengthAnimated = value;
+    emit lengthAnimatedChanged();
+
+    updateMaskArea();
+}
+
+bool PanelWindow::thicknessAnimated() const
+{
+    return m_thicknessAnimated;
+}
+
+void PanelWindow::setThicknessAnimated(bool value)
+{
+    if (m_thicknessAnimated == value) {
+        return;
+    }
+
+    m_thicknessAnimated = value;
+    emit thicknessAnimatedChanged();
+
+    updateMaskArea();
+}
+
+int PanelWindow::maskThicknessAutoHidden() const
+{
+    return m_maskThicknessAutoHidden;
+}
+
+void PanelWindow::setMaskThicknessAutoHidden(int value)
+{
+    if (m_maskThicknessAutoHidden == value) {
+        return;
+    }
+
+    m_maskThicknessAutoHidden = value;
+    emit maskThicknessAutoHiddenChanged();
+
+    updateMaskArea();
+}
+
+int PanelWindow::maskThicknessMid() const
+{
+    return m_maskThicknessMid;
+}
+
+void PanelWindow::setMaskThicknessMid(int value)
+{
+    if (m_maskThicknessMid == value) {
+        return;
+    }
+
+    m_maskThicknessMid = value;
+    emit maskThicknessMidChanged();
+
+    updateMaskArea();
+}
+
+int PanelWindow::maskThicknessNormal() const
+{
+    return m_maskThicknessNormal;
+}
+
+void PanelWindow::setMaskThicknessNormal(int value)
+{
+    if (m_maskThicknessNormal == value) {
+        return;
+    }
+
+    m_maskThicknessNormal = value;
+    emit maskThicknessNormalChanged();
+
+    updateMaskArea();
+}
+
+int PanelWindow::maskThicknessZoom() const
+{
+    return m_maskThicknessZoom;
+}
+
+void PanelWindow::setMaskThicknessZoom(int value)
+{
+    if (m_maskThicknessZoom == value) {
+        return;
+    }
+
+    m_maskThicknessZoom = value;
+    emit maskThicknessZoomChanged();
+
+    updateMaskArea();
+}
+
+qreal PanelWindow::zoomLengthIncrease() const
+{
+    return m_zoomLengthIncrease;
+}
+
+void PanelWindow::setZoomLengthIncrease(qreal value)
+{
+    if (m_zoomLengthIncrease == value) {
+        return;
+    }
+
+    m_zoomLengthIncrease = value;
+    emit zoomLengthIncreaseChanged();
+
+    updateMaskArea();
+}
+
+bool PanelWindow::normalState() const
+{
+    return m_normalState;
+}
+
+void PanelWindow::setNormalState(bool state)
+{
+    if (m_normalState == state) {
+        return;
+    }
+
+    m_normalState = state;
+    emit normalStateChanged();
 }
 
 QRect PanelWindow::maskArea() const
@@ -82,6 +406,8 @@ QRect PanelWindow::maskArea() const
 
 void PanelWindow::setMaskArea(QRect area)
 {
+    Instrumentation::Scope scope(Instrumentation::SetMaskArea);
+
     if (m_maskArea == area) {
         return;
     }
@@ -89,11 +415,135 @@ void PanelWindow::setMaskArea(QRect area)
     m_maskArea = area;
     m_interface->setMaskArea(area);
 
-    setMask(m_maskArea);
+    applyMask();
 
     emit maskAreaChanged();
 }
 
+void PanelWindow::applyMask()
+{
+    if (m_inputMaskOnly) {
+        m_interface->setInputMask(m_maskArea);
+    } else {
+        setMask(m_maskArea);
+    }
+}
+
+void PanelWindow::updateMaskArea()
+{
+    if (m_maskDirty) {
+        return;
+    }
+
+    m_maskDirty = true;
+    update();
+}
+
+/*
+ * Computes the mask area from its inputs, the mask covers only the
+ * contents of the dock in normal state and grows to the zoomed contents
+ * or the whole screen length while the contents are hovered or animated.
+ * The zoomed contents envelope is computed from the length of the contents
+ * before the zoom, so it doesn't change while the zoom follows the mouse.
+ */
+void PanelWindow::applyMaskArea()
+{
+    Instrumentation::Scope scope(Instrumentation::ApplyMaskArea);
+
+    if (!m_maskDirty) {
+        return;
+    }
+
+    m_maskDirty = false;
+
+    if (!KWindowSystem::compositingActive()) {
+        return;
+    }
+
+    bool horizontal = (m_panelOrientation == Qt::Horizontal);
+    bool normal = !m_contentsHovered && !m_contentsAnimated && !m_lengthAnimated;
+    //only the zoom is active and its extent is known
+    bool zoomOnly = !normal && (m_zoomLengthIncrease >= 0) && !m_contentsAnimated && !m_lengthAnimated;
+
+    qreal windowLength = horizontal ? width() : height();
+    qreal windowThickness = horizontal ? height() : width();
+
+    qreal length = windowLength;
+    qreal thickness = windowThickness;
+    qreal lengthPosition = 0;
+
+    qreal space = m_edgeSpacing + 10;
+
+    //the contents length is the zoomed one while the zoom is active
+    qreal contentsLength = zoomOnly ? m_hoverContentsLength : m_contentsLength;
+
+    if (normal || zoomOnly) {
+        if (m_alignment == Double) {
+            length = contentsLength + 0.5 * space;
+            lengthPosition = (windowLength / 2) - (contentsLength / 2) - 0.25 * space;
+        } else {
+            length = contentsLength + space;
+
+            if (m_alignment == Center) {
+                lengthPosition = (windowLength / 2) - (contentsLength / 2) - (space / 2);
+            } else if ((m_alignment == Right) || (m_alignment == Bottom)) {
+                lengthPosition = windowLength - contentsLength - (space / 2);
+            }
+        }
+
+        thickness = m_thicknessAnimated ? m_maskThicknessMid : m_maskThicknessNormal;
+
+        if (m_isAutoHidden && (m_panelVisibility == AutoHide)) {
+            thickness = m_maskThicknessAutoHidden;
+        }
+
+        if (!m_immutable) {
+            thickness = 2;
+        }
+
+        if (zoomOnly) {
+            length += m_zoomLengthIncrease;
+            thickness = m_maskThicknessZoom;
+
+            //the contents grow on both sides when they are centered and
+            //towards the start when they are aligned to the end
+            if ((m_alignment == Center) || (m_alignment == Double)) {
+                lengthPosition -= m_zoomLengthIncrease / 2;
+            } else if ((m_alignment == Right) || (m_alignment == Bottom)) {
+                lengthPosition -= m_zoomLengthIncrease;
+            }
+
+            lengthPosition = qMax(qreal(0), lengthPosition);
+        }
+    } else {
+        length = horizontal ? screenGeometry().width() : screenGeometry().height();
+
+        //grow only on length and not thickness
+        if (m_lengthAnimated) {
+            thickness = m_thicknessAnimated ? m_maskThicknessMid : m_maskThicknessNormal;
+        } else {
+            thickness = m_maskThicknessZoom;
+        }
+    }
+
+    qreal thicknessPosition = 0;
+
+    if ((m_location == Plasma::Types::BottomEdge) || (m_location == Plasma::Types::RightEdge)) {
+        thicknessPosition = windowThickness - thickness;
+    }
+
+    QRect area;
+
+    if (horizontal) {
+        area = QRect(qRound(lengthPosition), qRound(thicknessPosition), qRound(length), qRound(thickness));
+    } else {
+        area = QRect(qRound(thicknessPosition), qRound(lengthPosition), qRound(thickness), qRound(length));
+    }
+
+    setNormalState(normal);
+    setMaskArea(area);
+}
+
 Plasma::Types::Location PanelWindow::location() const
 {
     return m_location;
@@ -206,6 +656,23 @@ void PanelWindow::setChildrenLength(int value)
     emit childrenLengthChanged();
 }
 
+int PanelWindow::hideDelay() const
+{
+    return m_hideDelay;
+}
+
+void PanelWindow::setHideDelay(int delay)
+{
+    if (m_hideDelay == delay || delay < 0) {
+        return;
+    }
+
+    m_hideDelay = delay;
+    m_hideTimer.setInterval(m_hideDelay);
+
+    emit hideDelayChanged();
+}
+
 bool PanelWindow::disableHiding() const
 {
     return m_disableHiding;
@@ -222,8 +689,33 @@ void PanelWindow::setDisableHiding(bool value)
     emit disableHidingChanged();
 
     if (!m_disableHiding) {
-        m_updateStateTimer.start();
+        m_hideTimer.start();
+    }
+}
+
+bool PanelWindow::inputMaskOnly() const
+{
+    return m_inputMaskOnly;
+}
+
+void PanelWindow::setInputMaskOnly(bool state)
+{
+    if (m_inputMaskOnly == state) {
+        return;
     }
+
+    m_inputMaskOnly = state;
+
+    //reset the region that isn't used any more
+    if (m_inputMaskOnly) {
+        setMask(QRegion());
+    } else {
+        m_interface->setInputMask(QRect());
+    }
+
+    applyMask();
+
+    emit inputMaskOnlyChanged();
 }
 
 bool PanelWindow::immutable() const
@@ -258,6 +750,71 @@ void PanelWindow::setIsHovered(bool state)
     emit isHoveredChanged();
 }
 
+int PanelWindow::hoveredIndex() const
+{
+    return m_hoveredIndex;
+}
+
+QQuickItem *PanelWindow::hoveredItem() const
+{
+    return m_hoveredItem;
+}
+
+qreal PanelWindow::hoveredOffset() const
+{
+    return m_hoveredOffset;
+}
+
+/*
+ * All the values are stored before any of the signals is sent, so the
+ * handlers see the new state together.
+ */
+void PanelWindow::setHovered(int index, QQuickItem *item, qreal offset)
+{
+    bool indexChanged = (m_hoveredIndex != index);
+    bool itemChanged = (m_hoveredItem != item);
+    bool offsetChanged = (m_hoveredOffset != offset);
+    bool left = (m_hoveredIndex != -1) && (index == -1);
+
+    m_hoveredIndex = index;
+    m_hoveredItem = item;
+    m_hoveredOffset = offset;
+
+    if (itemChanged) {
+        emit hoveredItemChanged();
+    }
+
+    if (indexChanged) {
+        emit hoveredIndexChanged();
+    }
+
+    if (offsetChanged) {
+        emit hoveredOffsetChanged();
+    }
+
+    if (left) {
+        emit hoverLeft();
+    }
+}
+
+void PanelWindow::updateHovered(const QPointF &point)
+{
+    Instrumentation::Scope scope(Instrumentation::UpdateHovered);
+
+    //the index follows the items that are moving under the mouse, e.g. during the zoom
+    int index = -1;
+    QQuickItem *item = m_hoverIndex.itemAt(point.toPoint(), &index);
+
+    if (!item) {
+        setHovered(-1, 0, m_hoveredOffset);
+        return;
+    }
+
+    QPointF position = item->mapFromScene(point);
+
+    setHovered(index, item, (m_panelOrientation == Qt::Horizontal) ? position.x() : position.y());
+}
+
 void PanelWindow::setPanelOrientation(Plasma::Types::Location location)
 {
     if ((location == Plasma::Types::LeftEdge) || (location == Plasma::Types::RightEdge)) {
@@ -265,6 +822,9 @@ void PanelWindow::setPanelOrientation(Plasma::Types::Location location)
     } else {
         m_panelOrientation = Qt::Horizontal;
     }
+
+    m_appletIndex.setOrientation(m_panelOrientation);
+    m_hoverIndex.setOrientation(m_panelOrientation);
 }
 
 void PanelWindow::setTransientThickness(unsigned int thickness)
@@ -310,34 +870,194 @@ void PanelWindow::setTransientThickness(unsigned int thickness)
     }
 }
 
-/******************************/
-void PanelWindow::addAppletItem(QObject *item)
+/******************************/
+void PanelWindow::addAppletItem(QObject *item)
+{
+    PlasmaQuick::AppletQuickItem *dynItem = qobject_cast<PlasmaQuick::AppletQuickItem *>(item);
+
+    if (dynItem && !m_containment) {
+        Plasma::Applet *applet = dynItem->applet();
+        if (applet) {
+            m_containment = applet->containment();
+
+            if (m_containment) {
+                connect(m_containment, SIGNAL(immutabilityChanged(Plasma::Types::ImmutabilityType)), this, SLOT(clearContextMenus()));
+            }
+        }
+    }
+
+    if (!dynItem || m_appletItems.contains(dynItem)) {
+        return;
+    }
+
+    m_appletItems.append(dynItem);
+    connect(dynItem, SIGNAL(destroyed(QObject *)), this, SLOT(appletItemDestroyed(QObject *)));
+
+    trackAppletGeometry(dynItem);
+
+    if (dynItem->isVisible() && (dynItem->window() == this)) {
+        m_appletIndex.insert(dynItem);
+    }
+}
+
+void PanelWindow::removeAppletItem(QObject *item)
+{
+    PlasmaQuick::AppletQuickItem *dynItem = qobject_cast<PlasmaQuick::AppletQuickItem *>(item);
+
+    if (!dynItem) {
+        return;
+    }
+
+    disconnect(dynItem, SIGNAL(destroyed(QObject *)), this, SLOT(appletItemDestroyed(QObject *)));
+
+    m_appletItems.removeAll(dynItem);
+    m_appletIndex.remove(dynItem);
+}
+
+void PanelWindow::setHoverItem(int index, QQuickItem *item)
+{
+    if (!item || (m_hoverItems.value(index) == item)) {
+        return;
+    }
+
+    removeHoverItem(item);
+    removeHoverItem(m_hoverItems.value(index));
+    m_hoverItems.insert(index, item);
+    connect(item, SIGNAL(destroyed(QObject *)), this, SLOT(appletItemDestroyed(QObject *)), Qt::UniqueConnection);
+
+    trackAppletGeometry(item);
+
+    if (item->isVisible() && (item->window() == this)) {
+        m_hoverIndex.insert(item, index);
+    }
+}
+
+void PanelWindow::removeHoverItem(QQuickItem *item)
+{
+    int index = m_hoverItems.key(item, -1);
+
+    if (!item || (index == -1)) {
+        return;
+    }
+
+    disconnect(item, SIGNAL(destroyed(QObject *)), this, SLOT(appletItemDestroyed(QObject *)));
+
+    m_hoverItems.remove(index);
+    m_hoverIndex.remove(item);
+
+    if (m_hoveredItem == item) {
+        setHovered(-1, 0, m_hoveredOffset);
+    }
+}
+
+Plasma::Applet *PanelWindow::appletAt(const QPoint &point)
+{
+    PlasmaQuick::AppletQuickItem *item = qobject_cast<PlasmaQuick::AppletQuickItem *>(m_appletIndex.itemAt(point));
+
+    return item ? item->applet() : 0;
+}
+
+/*
+ * The geometry of an applet in the window changes also when any of
+ * its ancestors is moved or resized, so all of them are tracked.
+ */
+void PanelWindow::trackAppletGeometry(QQuickItem *item)
+{
+    while (item && item != contentItem()) {
+        connect(item, SIGNAL(xChanged()), this, SLOT(invalidateAppletOrder()), Qt::UniqueConnection);
+        connect(item, SIGNAL(yChanged()), this, SLOT(invalidateAppletOrder()), Qt::UniqueConnection);
+        connect(item, SIGNAL(widthChanged()), this, SLOT(invalidateAppletOrder()), Qt::UniqueConnection);
+        connect(item, SIGNAL(heightChanged()), this, SLOT(invalidateAppletOrder()), Qt::UniqueConnection);
+        connect(item, SIGNAL(visibleChanged()), this, SLOT(invalidateAppletIndex()), Qt::UniqueConnection);
+        connect(item, SIGNAL(parentChanged(QQuickItem *)), this, SLOT(appletParentChanged()), Qt::UniqueConnection);
+
+        item = item->parentItem();
+    }
+}
+
+void PanelWindow::appletParentChanged()
 {
-    PlasmaQuick::AppletQuickItem *dynItem = qobject_cast<PlasmaQuick::AppletQuickItem *>(item);
+    m_appletTrackingDirty = true;
+    invalidateAppletIndex();
+}
 
-    if (dynItem && !m_containment) {
-        Plasma::Applet *applet = dynItem->applet();
-        if (applet) {
-            m_containment = applet->containment();
+void PanelWindow::invalidateAppletIndex()
+{
+    m_appletIndexTimer.start();
+}
+
+void PanelWindow::invalidateAppletOrder()
+{
+    m_appletOrderTimer.start();
+}
+
+void PanelWindow::appletItemDestroyed(QObject *item)
+{
+    //the index reads the geometries of its items, the pointers of the
+    //applets are already cleared and the item is compared only as a QObject
+    m_appletItems.removeAll(QPointer<PlasmaQuick::AppletQuickItem>());
+    m_appletIndex.remove(item);
+
+    //the pointers of the hover items are already cleared
+    for (auto it = m_hoverItems.begin(); it != m_hoverItems.end();) {
+        if (it.value()) {
+            ++it;
+        } else {
+            it = m_hoverItems.erase(it);
         }
     }
 
-    if (!dynItem || m_appletItems.contains(dynItem)) {
-        return;
+    m_hoverIndex.remove(item);
+
+    if (!m_hoveredItem && (m_hoveredIndex != -1)) {
+        setHovered(-1, 0, m_hoveredOffset);
     }
+}
 
-    m_appletItems.append(dynItem);
+void PanelWindow::sortAppletIndex()
+{
+    m_appletIndex.sort();
+    m_hoverIndex.sort();
 }
 
-void PanelWindow::removeAppletItem(QObject *item)
+void PanelWindow::rebuildAppletIndex()
 {
-    PlasmaQuick::AppletQuickItem *dynItem = qobject_cast<PlasmaQuick::AppletQuickItem *>(item);
+    m_appletIndexTimer.stop();
 
-    if (!dynItem) {
-        return;
+    m_appletIndex.clear();
+    m_hoverIndex.clear();
+
+    foreach (PlasmaQuick::AppletQuickItem *ai, m_appletItems) {
+        if (!ai) {
+            continue;
+        }
+
+        if (m_appletTrackingDirty) {
+            trackAppletGeometry(ai);
+        }
+
+        if (ai->isVisible() && (ai->window() == this)) {
+            m_appletIndex.insert(ai);
+        }
     }
 
-    m_appletItems.removeAll(dynItem);
+    for (auto it = m_hoverItems.constBegin(); it != m_hoverItems.constEnd(); ++it) {
+        QQuickItem *item = it.value();
+
+        if (!item) {
+            continue;
+        }
+
+        if (m_appletTrackingDirty) {
+            trackAppletGeometry(item);
+        }
+
+        if (item->isVisible() && (item->window() == this)) {
+            m_hoverIndex.insert(item, it.key());
+        }
+    }
+
+    m_appletTrackingDirty = false;
 }
 
 /*******************************/
@@ -446,111 +1166,138 @@ void PanelWindow::updateVisibilityFlags()
     setFlags(Qt::Tool|Qt::FramelessWindowHint|Qt::WindowDoesNotAcceptFocus);
     m_interface->setDockToAllDesktops();
 
+    //every mode starts with the dock raised
+    m_visibilityState = Raised;
+
     if (m_panelVisibility == AlwaysVisible) {
         m_interface->setDockToAlwaysVisible();
         updateWindowPosition();
     } else {
         updateWindowPosition();
         showOnTop();
-        m_updateStateTimer.start();
+        m_hideTimer.start();
     }
 
-    if (m_panelVisibility == AutoHide) {
-        m_updateStateTimer.setInterval(2500);
-    } else {
-        m_updateStateTimer.setInterval(1500);
-    }
+    requestUpdateState();
 }
 
 void PanelWindow::menuAboutToHide()
 {
+    m_contextMenu.clear();
     setDisableHiding(false);
-    m_updateStateTimer.start();
+}
+
+void PanelWindow::requestUpdateState()
+{
+    if (!m_updateStateTimer.isActive()) {
+        m_updateStateTimer.start();
+    }
 }
 
 /*
- * It is used from the m_updateStateTimer in order to check the dock's
- * visibility and trigger events and actions which are needed to
- * respond accordingly
+ * The visibility state machine of the dock. The dock is either raised, on
+ * top of the windows, or lowered, below them or hidden in the auto hide
+ * mode. The state is evaluated only when one of its inputs has changed
+ * (active window, windows covering the dock, the layer of the dock, hover,
+ * attention, hiding disabled) and the dock is moved only on a transition:
+ *
+ *   mode              lowered when                          raised when
+ *   BelowActive       the active window overlaps the dock   it doesn't any more
+ *   BelowMaximized    the active maximized window does      it doesn't any more
+ *   LetWindowsCover   always                                -
+ *   AutoHide          always                                -
+ *   WindowsGoBelow    never
+ *   AlwaysVisible     never
+ *
+ * In every mode the dock is raised while it is hovered or a window asks
+ * for attention. A raised dock isn't lowered while hiding is disabled and
+ * before the hide delay after the mouse has left it.
  */
 void PanelWindow::updateState()
 {
-    //qDebug() << "in update state disableHiding:" <<m_disableHiding;
+    Instrumentation::Scope scope(Instrumentation::UpdateState);
 
-    //update the dock behavior
-    switch (m_panelVisibility) {
-    case BelowActive:
-        if ( !m_interface->desktopIsActive() && m_interface->dockIntersectsActiveWindow() ) {
-            if ( m_interface->dockIsOnTop() ) {
-                if (!m_isHovered && !m_windowIsInAttention && !m_disableHiding) {
-                    mustBeLowered();                    //showNormal();
-                }
-            } else {
-                if ( m_windowIsInAttention ) {
-                    mustBeRaised();                     //showOnTop();
-                }
-            }
-        } else if (m_interface->dockInNormalState()){
-            if(!m_interface->desktopIsActive() && m_interface->dockIsCovered()) {
-                mustBeRaised();
-            } else {
-                showOnTop();
-            }
-        }
-        break;
-    case BelowMaximized:
-        if ( !m_interface->desktopIsActive() && m_interface->activeIsMaximized() && m_interface->dockIntersectsActiveWindow() ) {
-            if ( m_interface->dockIsOnTop() ) {
-                if (!m_isHovered && !m_windowIsInAttention && !m_disableHiding) {
-                    mustBeLowered();                    //showNormal();
-                }
-            } else {
-                if ( m_windowIsInAttention ) {
-                    mustBeRaised();                     //showOnTop();
-                }
-            }
-        } else if ( m_interface->dockInNormalState() ) {
-            if(!m_interface->desktopIsActive() && m_interface->dockIsCovered()) {
-                mustBeRaised();
-            } else {
-                showOnTop();
-            }
-        }
-        break;
-    case LetWindowsCover:
-        if (!m_isHovered && m_interface->dockIsOnTop()) {
-            if( m_interface->dockIsCovering()  ) {
-                if (!m_disableHiding) {
-                    mustBeLowered();
-                }
-            } else {
-                showOnBottom();
-            }
-        } else if ( m_windowIsInAttention ) {
-            if( !m_interface->dockIsOnTop() ) {
-                if (m_interface->dockIsCovered()) {
-                    mustBeRaised();
-                } else {
-                    showOnTop();
-                }
-            }
-        }
-        break;
-    case WindowsGoBelow:
-        //Do nothing, the dock is OnTop state in every case
-        break;
-    case AutoHide:
-        if (m_windowIsInAttention && m_isAutoHidden) {
+    VisibilityState state = nextState();
+
+    if (state != m_visibilityState) {
+        setVisibilityState(state);
+    }
+}
+
+PanelWindow::VisibilityState PanelWindow::nextState() const
+{
+    if ((m_panelVisibility == WindowsGoBelow) || (m_panelVisibility == AlwaysVisible)
+            || m_isHovered || m_windowIsInAttention) {
+        return Raised;
+    }
+
+    bool lowered = true;
+
+    if (m_panelVisibility == BelowActive) {
+        lowered = !m_interface->desktopIsActive() && m_interface->dockIntersectsActiveWindow();
+    } else if (m_panelVisibility == BelowMaximized) {
+        lowered = !m_interface->desktopIsActive() && m_interface->activeIsMaximized()
+                  && m_interface->dockIntersectsActiveWindow();
+    }
+
+    if (!lowered || ((m_visibilityState == Raised) && (m_disableHiding || m_hideTimer.isActive()))) {
+        return Raised;
+    }
+
+    return Lowered;
+}
+
+/*
+ * The sliding animations of the QML part move the dock to its new layer
+ * when it is out of sight, they are not needed when there isn't any window
+ * on the way.
+ */
+void PanelWindow::setVisibilityState(VisibilityState state)
+{
+    m_visibilityState = state;
+
+    if (state == Raised) {
+        m_hideTimer.stop();
+
+        //a hovered dock is already in sight
+        if ((m_panelVisibility != AutoHide) && (m_isHovered || !m_interface->dockIsCovered())) {
+            showOnTop();
+        } else {
             emit mustBeRaised();
-        } else if (!m_isHovered && !m_disableHiding) {
+        }
+    } else {
+        if ((m_panelVisibility == LetWindowsCover) && !m_interface->dockIsCovering()) {
+            showOnBottom();
+        } else {
             emit mustBeLowered();
         }
-        break;
-    case AlwaysVisible:
-        //Do nothing, the dock in OnTop state in every case
-        break;
+    }
+}
+
+void PanelWindow::raiseRequested()
+{
+    m_visibilityState = Raised;
+    requestUpdateState();
+}
+
+void PanelWindow::lowerRequested()
+{
+    m_visibilityState = Lowered;
+    requestUpdateState();
+}
+
+/*
+ * The layer of the dock is changed asynchronously, a sliding animation
+ * that was requested before the last transition can still move the raised
+ * dock below the windows when it finishes.
+ */
+void PanelWindow::dockStateChanged()
+{
+    if ((m_visibilityState == Raised) && (m_panelVisibility != AutoHide) && !m_interface->dockIsOnTop()) {
+        showOnTop();
     }
 
+    requestUpdateState();
 }
 
 void PanelWindow::showOnTop()
@@ -581,11 +1328,7 @@ void PanelWindow::activeWindowChanged()
         return;
     }
 
-    //this check is important because otherwise the signals are so often
-    //that the timer is never triggered
-    if ( !m_updateStateTimer.isActive() ) {
-        m_updateStateTimer.start();
-    }
+    requestUpdateState();
 }
 
 bool PanelWindow::event(QEvent *event)
@@ -596,25 +1339,30 @@ bool PanelWindow::event(QEvent *event)
 
     QQuickWindow::event(event);
 
+    //the items have already handled the event, e.g. the Now Dock plasmoid knows its hovered task
+    if (event->type() == QEvent::MouseMove) {
+        QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+
+        //the hovered item doesn't change while the mouse is pressed
+        if (mouseEvent->buttons() == Qt::NoButton) {
+            updateHovered(mouseEvent->localPos());
+        }
+    } else if (event->type() == QEvent::Leave) {
+        setHovered(-1, 0, m_hoveredOffset);
+    }
+
+    //the state machine raises the hovered dock and lowers it after the hide delay
     if (event->type() == QEvent::Enter) {
+        m_hideTimer.stop();
         setIsHovered(true);
-        m_updateStateTimer.stop();
         shrinkTransient();
-
-        if (m_panelVisibility == AutoHide) {
-            if (m_isAutoHidden) {
-                emit mustBeRaised();
-            }
-        } else {
-            showOnTop();
-        }
     } else if ((event->type() == QEvent::Leave) && (!isActive()) ) {
-        setIsHovered(false);
-
         if ( (m_panelVisibility != WindowsGoBelow)
              && (m_panelVisibility != AlwaysVisible) ) {
-            m_updateStateTimer.start();
+            m_hideTimer.start();
         }
+
+        setIsHovered(false);
     }
 
     return true;
@@ -647,7 +1395,7 @@ void PanelWindow::mousePressEvent(QMouseEvent *event)
     }
 
     const QString trigger = Plasma::ContainmentActions::eventToString(event);
-    Plasma::ContainmentActions *plugin = m_containment->containmentActions().value(trigger);
+    Plasma::ContainmentActions *plugin = containmentActionsPlugin(trigger);
 
     if (!plugin || plugin->contextualActions().isEmpty()) {
         event->setAccepted(false);
@@ -665,21 +1413,7 @@ void PanelWindow::mousePressEvent(QMouseEvent *event)
         return;
     }
 
-    //FIXME: very inefficient appletAt() implementation
-    Plasma::Applet *applet = 0;
-    foreach (PlasmaQuick::AppletQuickItem *ai, m_appletItems) {
-        if (ai && ai->isVisible() && ai->contains(ai->mapFromItem(contentItem(), event->pos()))) {
-            applet = ai->applet();
-            break;
-        } else {
-            ai = 0;
-        }
-    }
-
-    QMenu *desktopMenu = new QMenu;
-    desktopMenu->setAttribute(Qt::WA_DeleteOnClose);
-
-    m_contextMenu = desktopMenu;
+    Plasma::Applet *applet = appletAt(event->pos());
 
     if (this->mouseGrabberItem()) {
         //workaround, this fixes for me most of the right click menu behavior
@@ -697,16 +1431,18 @@ void PanelWindow::mousePressEvent(QMouseEvent *event)
 
     if (applet) {
         emit applet->contextualActionsAboutToShow();
-        addAppletActions(desktopMenu, applet, event);
     } else {
         emit m_containment->contextualActionsAboutToShow();
-        addContainmentActions(desktopMenu, event);
     }
 
-    //this is a workaround where Qt now creates the menu widget
-    //in .exec before oxygen can polish it and set the following attribute
-    desktopMenu->setAttribute(Qt::WA_TranslucentBackground);
-    //end workaround
+    QMenu *desktopMenu = contextMenu(applet, plugin);
+
+    if (desktopMenu->isEmpty()) {
+        event->accept();
+        return;
+    }
+
+    m_contextMenu = desktopMenu;
 
     QPoint pos = event->globalPos();
     if (applet) {
@@ -732,101 +1468,182 @@ void PanelWindow::mousePressEvent(QMouseEvent *event)
         pos = QPoint(x,y);
     }
 
-    if (desktopMenu->isEmpty()) {
-        delete desktopMenu;
-        event->accept();
-        return;
-    }
-
-    connect(desktopMenu, SIGNAL(aboutToHide()), this, SLOT(menuAboutToHide()));
     setDisableHiding(true);
     desktopMenu->popup(pos);
 
     event->setAccepted(true);
 }
 
-void PanelWindow::addAppletActions(QMenu *desktopMenu, Plasma::Applet *applet, QEvent *event)
+/*
+ * The menus are reused as long as they would be built from the same actions,
+ * the applets can change their contextual actions just before they are shown.
+ */
+QMenu *PanelWindow::contextMenu(Plasma::Applet *applet, Plasma::ContainmentActions *plugin)
+{
+    ContextMenu current;
+    current.containmentActions = containmentActions(plugin);
+    current.containmentEntries = 0;
+    current.removeAction = 0;
+
+    //count number of real actions
+    foreach (QAction *action, current.containmentActions) {
+        if (current.containmentEntries < 2 && action->isVisible() && !action->isSeparator()) {
+            ++current.containmentEntries;
+        }
+    }
+
+    if (applet) {
+        current.appletActions = appletActions(applet);
+        current.removeAction = appletRemoveAction(applet);
+    }
+
+    QHash<Plasma::Applet *, ContextMenu>::iterator it = m_contextMenus.find(applet);
+
+    if (it != m_contextMenus.end()) {
+        const ContextMenu &cached = it.value();
+
+        if (cached.menu && (cached.appletActions == current.appletActions)
+                && (cached.containmentActions == current.containmentActions)
+                && (cached.containmentEntries == current.containmentEntries)
+                && (cached.removeAction == current.removeAction)) {
+            return cached.menu;
+        }
+
+        //the menu is never visible here, the open one is closed on the next click
+        delete cached.menu.data();
+    } else if (applet) {
+        connect(applet, SIGNAL(destroyed(QObject *)), this, SLOT(appletDestroyed(QObject *)), Qt::UniqueConnection);
+    }
+
+    QMenu *desktopMenu = new QMenu;
+
+    //this is a workaround where Qt now creates the menu widget
+    //in .exec before oxygen can polish it and set the following attribute
+    desktopMenu->setAttribute(Qt::WA_TranslucentBackground);
+    //end workaround
+
+    connect(desktopMenu, SIGNAL(aboutToHide()), this, SLOT(menuAboutToHide()));
+
+    if (applet) {
+        addAppletActions(desktopMenu, current);
+    } else {
+        desktopMenu->addActions(current.containmentActions);
+    }
+
+    current.menu = desktopMenu;
+    m_contextMenus.insert(applet, current);
+
+    return desktopMenu;
+}
+
+void PanelWindow::addAppletActions(QMenu *desktopMenu, const ContextMenu &actions)
+{
+    desktopMenu->addActions(actions.appletActions);
+
+    if (actions.containmentEntries) {
+        //if there is only one, don't create a submenu
+        if (actions.containmentEntries < 2) {
+            foreach (QAction *action, actions.containmentActions) {
+                if (action->isVisible() && !action->isSeparator()) {
+                    desktopMenu->addAction(action);
+                }
+            }
+        } else {
+            QMenu *containmentMenu = new QMenu(i18nc("%1 is the name of the containment", "%1 Options", m_containment->title()), desktopMenu);
+            containmentMenu->addActions(actions.containmentActions);
+            desktopMenu->addMenu(containmentMenu);
+        }
+    }
+
+    if (actions.removeAction) {
+        if (!desktopMenu->isEmpty()) {
+            desktopMenu->addSeparator();
+        }
+
+        //qDebug() << "adding close action" << closeApplet->isEnabled() << closeApplet->isVisible();
+        desktopMenu->addAction(actions.removeAction);
+    }
+}
+
+QList<QAction *> PanelWindow::appletActions(Plasma::Applet *applet) const
 {
+    QList<QAction *> actions;
+
     foreach (QAction *action, applet->contextualActions()) {
         if (action) {
-            desktopMenu->addAction(action);
+            actions.append(action);
         }
     }
 
     if (!applet->failedToLaunch()) {
         QAction *runAssociatedApplication = applet->actions()->action(QStringLiteral("run associated application"));
         if (runAssociatedApplication && runAssociatedApplication->isEnabled()) {
-            desktopMenu->addAction(runAssociatedApplication);
+            actions.append(runAssociatedApplication);
         }
 
         QAction *configureApplet = applet->actions()->action(QStringLiteral("configure"));
         if (configureApplet && configureApplet->isEnabled()) {
-            desktopMenu->addAction(configureApplet);
+            actions.append(configureApplet);
         }
         QAction *appletAlternatives = applet->actions()->action(QStringLiteral("alternatives"));
         if (appletAlternatives && appletAlternatives->isEnabled()) {
-            desktopMenu->addAction(appletAlternatives);
+            actions.append(appletAlternatives);
         }
     }
 
-    QMenu *containmentMenu = new QMenu(i18nc("%1 is the name of the containment", "%1 Options", m_containment->title()), desktopMenu);
-    addContainmentActions(containmentMenu, event);
-
-    if (!containmentMenu->isEmpty()) {
-        int enabled = 0;
-        //count number of real actions
-        QListIterator<QAction *> actionsIt(containmentMenu->actions());
-        while (enabled < 3 && actionsIt.hasNext()) {
-            QAction *action = actionsIt.next();
-            if (action->isVisible() && !action->isSeparator()) {
-                ++enabled;
-            }
-        }
-
-        if (enabled) {
-            //if there is only one, don't create a submenu
-            if (enabled < 2) {
-                foreach (QAction *action, containmentMenu->actions()) {
-                    if (action->isVisible() && !action->isSeparator()) {
-                        desktopMenu->addAction(action);
-                    }
-                }
-            } else {
-                desktopMenu->addMenu(containmentMenu);
-            }
-        }
-    }
+    return actions;
+}
 
+QAction *PanelWindow::appletRemoveAction(Plasma::Applet *applet) const
+{
     if (m_containment->immutability() == Plasma::Types::Mutable &&
             (m_containment->containmentType() != Plasma::Types::PanelContainment || m_containment->isUserConfiguring())) {
-        QAction *closeApplet = applet->actions()->action(QStringLiteral("remove"));
         //qDebug() << "checking for removal" << closeApplet;
-        if (closeApplet) {
-            if (!desktopMenu->isEmpty()) {
-                desktopMenu->addSeparator();
-            }
-
-            //qDebug() << "adding close action" << closeApplet->isEnabled() << closeApplet->isVisible();
-            desktopMenu->addAction(closeApplet);
-        }
+        return applet->actions()->action(QStringLiteral("remove"));
     }
-}
 
+    return 0;
+}
 
-void PanelWindow::addContainmentActions(QMenu *desktopMenu, QEvent *event)
+QList<QAction *> PanelWindow::containmentActions(Plasma::ContainmentActions *plugin) const
 {
+    QList<QAction *> actions;
+
     if (m_containment->corona()->immutability() != Plasma::Types::Mutable &&
             !KAuthorized::authorizeKAction(QStringLiteral("plasma/containment_actions"))) {
         //qDebug() << "immutability";
-        return;
+        return actions;
     }
 
-    //this is what ContainmentPrivate::prepareContainmentActions was
-    const QString trigger = Plasma::ContainmentActions::eventToString(event);
+    if (!plugin) {
+        return actions;
+    }
+
+    actions = plugin->contextualActions();
+
+    if (actions.isEmpty()) {
+        //it probably didn't bother implementing the function. give the user a chance to set
+        //a better plugin.  note that if the user sets no-plugin this won't happen...
+        if ((m_containment->containmentType() != Plasma::Types::PanelContainment &&
+             m_containment->containmentType() != Plasma::Types::CustomPanelContainment) &&
+                m_containment->actions()->action(QStringLiteral("configure"))) {
+            actions.append(m_containment->actions()->action(QStringLiteral("configure")));
+        }
+    }
+
+    return actions;
+}
+
+/*
+ * this is what ContainmentPrivate::prepareContainmentActions was, the plugin
+ * configuration is restored only the first time that it is used by the dock
+ */
+Plasma::ContainmentActions *PanelWindow::containmentActionsPlugin(const QString &trigger)
+{
     Plasma::ContainmentActions *plugin = m_containment->containmentActions().value(trigger);
 
     if (!plugin) {
-        return;
+        return 0;
     }
 
     if (plugin->containment() != m_containment) {
@@ -839,21 +1656,31 @@ void PanelWindow::addContainmentActions(QMenu *desktopMenu, QEvent *event)
         plugin->restore(pluginConfig);
     }
 
-    QList<QAction *> actions = plugin->contextualActions();
+    return plugin;
+}
 
-    if (actions.isEmpty()) {
-        //it probably didn't bother implementing the function. give the user a chance to set
-        //a better plugin.  note that if the user sets no-plugin this won't happen...
-        if ((m_containment->containmentType() != Plasma::Types::PanelContainment &&
-             m_containment->containmentType() != Plasma::Types::CustomPanelContainment) &&
-                m_containment->actions()->action(QStringLiteral("configure"))) {
-            desktopMenu->addAction(m_containment->actions()->action(QStringLiteral("configure")));
+void PanelWindow::appletDestroyed(QObject *applet)
+{
+    QHash<Plasma::Applet *, ContextMenu>::iterator it = m_contextMenus.find(static_cast<Plasma::Applet *>(applet));
+
+    if (it != m_contextMenus.end()) {
+        if (it.value().menu) {
+            it.value().menu->deleteLater();
+        }
+
+        m_contextMenus.erase(it);
+    }
+}
+
+void PanelWindow::clearContextMenus()
+{
+    foreach (const ContextMenu &menu, m_contextMenus) {
+        if (menu.menu) {
+            menu.menu->deleteLater();
         }
-    } else {
-        desktopMenu->addActions(actions);
     }
 
-    return;
+    m_contextMenus.clear();
 }
 
 
@@ -871,10 +1698,18 @@ void PanelWindow::screenChanged(QScreen *screen)
     }
 }
 
+void PanelWindow::updateInterfaceScreen()
+{
+    if (m_interface) {
+        m_interface->setScreenGeometry(screenGeometry());
+        requestUpdateState();
+    }
+}
+
 void PanelWindow::showEvent(QShowEvent *event)
 {
     if ( !m_maskArea.isNull() ) {
-        setMask(m_maskArea);
+        applyMask();
     }
 }
 
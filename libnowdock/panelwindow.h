@@ -1,6 +1,7 @@
 #ifndef PANELWINDOW_H
 #define PANELWINDOW_H
 
+#include <QMap>
 #include <QMenu>
 #include <QQuickWindow>
 #include <QTimer>
@@ -12,6 +13,7 @@
 #include <PlasmaQuick/AppletQuickItem>
 
 #include "abstractinterface.h"
+#include "appletgeometryindex.h"
 
 namespace NowDock
 {
@@ -27,20 +29,68 @@ class PanelWindow : public QQuickWindow {
 
     Q_PROPERTY(bool isHovered READ isHovered NOTIFY isHoveredChanged)
 
+    /**
+     * the applet container under the mouse, its index in the layouts and the
+     * position of the mouse inside it along the dock. They are found from the
+     * items that are registered with setHoverItem, hoveredIndex is -1 when
+     * none of them is hovered
+     */
+    Q_PROPERTY(int hoveredIndex READ hoveredIndex NOTIFY hoveredIndexChanged)
+    Q_PROPERTY(QQuickItem *hoveredItem READ hoveredItem NOTIFY hoveredItemChanged)
+    Q_PROPERTY(qreal hoveredOffset READ hoveredOffset NOTIFY hoveredOffsetChanged)
+
     Q_PROPERTY(bool disableHiding READ disableHiding WRITE setDisableHiding NOTIFY disableHidingChanged)
 
     Q_PROPERTY(bool windowInAttention READ windowInAttention WRITE setWindowInAttention NOTIFY windowInAttentionChanged)
 
     Q_PROPERTY(int childrenLength READ childrenLength WRITE setChildrenLength NOTIFY childrenLengthChanged)
 
+    /**
+     * the grace period in ms before the dock is lowered after the mouse has left it
+     * or hiding has been enabled again, e.g. after a context menu was closed
+     */
+    Q_PROPERTY(int hideDelay READ hideDelay WRITE setHideDelay NOTIFY hideDelayChanged)
+
     Q_PROPERTY(unsigned int maximumLength READ maximumLength NOTIFY maximumLengthChanged)
 
+    /**
+     * the inputs of the mask area, it is computed from them at most once per frame
+     * alignment: the alignment of the contents or Double for the double layout
+     * contentsLength: the length of the applets layout, both layouts for Double,
+     *     it grows with the zoom while the contents are hovered
+     * contentsHovered, contentsAnimated, lengthAnimated, thicknessAnimated:
+     *     the states that make the mask larger than the contents
+     * zoomLengthIncrease: how much longer the zoom makes the contents,
+     *     negative when it is not known
+     */
+    Q_PROPERTY(int alignment READ alignment WRITE setAlignment NOTIFY alignmentChanged)
+    Q_PROPERTY(bool contentsAnimated READ contentsAnimated WRITE setContentsAnimated NOTIFY contentsAnimatedChanged)
+    Q_PROPERTY(bool contentsHovered READ contentsHovered WRITE setContentsHovered NOTIFY contentsHoveredChanged)
+    Q_PROPERTY(int contentsLength READ contentsLength WRITE setContentsLength NOTIFY contentsLengthChanged)
+    Q_PROPERTY(int edgeSpacing READ edgeSpacing WRITE setEdgeSpacing NOTIFY edgeSpacingChanged)
+    Q_PROPERTY(bool lengthAnimated READ lengthAnimated WRITE setLengthAnimated NOTIFY lengthAnimatedChanged)
+    Q_PROPERTY(bool thicknessAnimated READ thicknessAnimated WRITE setThicknessAnimated NOTIFY thicknessAnimatedChanged)
+    Q_PROPERTY(int maskThicknessAutoHidden READ maskThicknessAutoHidden WRITE setMaskThicknessAutoHidden NOTIFY maskThicknessAutoHiddenChanged)
+    Q_PROPERTY(int maskThicknessMid READ maskThicknessMid WRITE setMaskThicknessMid NOTIFY maskThicknessMidChanged)
+    Q_PROPERTY(int maskThicknessNormal READ maskThicknessNormal WRITE setMaskThicknessNormal NOTIFY maskThicknessNormalChanged)
+    Q_PROPERTY(int maskThicknessZoom READ maskThicknessZoom WRITE setMaskThicknessZoom NOTIFY maskThicknessZoomChanged)
+    Q_PROPERTY(qreal zoomLengthIncrease READ zoomLengthIncrease WRITE setZoomLengthIncrease NOTIFY zoomLengthIncreaseChanged)
+
+    Q_PROPERTY(bool normalState READ normalState NOTIFY normalStateChanged)
+
+    /**
+     * the mask area is applied only to the input region of the window, the
+     * visible region stays the whole window and isn't reshaped on every
+     * change of the mask
+     */
+    Q_PROPERTY(bool inputMaskOnly READ inputMaskOnly WRITE setInputMaskOnly NOTIFY inputMaskOnlyChanged)
+
     /**
      * the window mask, can be used in real transparent panels that set only the visual area
      * of the window
      * @since 5.8
      */
-    Q_PROPERTY(QRect maskArea READ maskArea WRITE setMaskArea NOTIFY maskAreaChanged)
+    Q_PROPERTY(QRect maskArea READ maskArea NOTIFY maskAreaChanged)
 
     /**
      * the dock's screen geometry, e.g. it is used to set correctly x, y values
@@ -79,19 +129,75 @@ public:
     bool immutable() const;
     void setImmutable(bool state);
 
+    bool inputMaskOnly() const;
+    void setInputMaskOnly(bool state);
+
     bool isAutoHidden() const;
     void setIsAutoHidden(bool state);
 
     bool isHovered() const;
 
+    int hoveredIndex() const;
+    QQuickItem *hoveredItem() const;
+    qreal hoveredOffset() const;
+
     bool windowInAttention() const;
    // void setWindowInAttention(bool state);
 
     int childrenLength() const;
     void setChildrenLength(int value);
 
+    int hideDelay() const;
+    void setHideDelay(int delay);
+
     unsigned int maximumLength() const;
 
+    int alignment() const;
+    void setAlignment(int value);
+
+    bool contentsAnimated() const;
+    void setContentsAnimated(bool value);
+
+    bool contentsHovered() const;
+    void setContentsHovered(bool value);
+
+    int contentsLength() const;
+    void setContentsLength(int value);
+
+    int edgeSpacing() const;
+    void setEdgeSpacing(int value);
+
+    bool lengthAnimated() const;
+    void setLengthAnimated(bool value);
+
+    bool thicknessAnimated() const;
+    void setThicknessAnimated(bool value);
+
+    int maskThicknessAutoHidden() const;
+    void setMaskThicknessAutoHidden(int value);
+
+    int maskThicknessMid() const;
+    void setMaskThicknessMid(int value);
+
+    int maskThicknessNormal() const;
+    void setMaskThicknessNormal(int value);
+
+    int maskThicknessZoom() const;
+    void setMaskThicknessZoom(int value);
+
+    qreal zoomLengthIncrease() const;
+    void setZoomLengthIncrease(qreal value);
+
+    bool normalState() const;
+
+    AbstractInterface *interface() const;
+    //the window system backend that the visibility state is based on,
+    //XWindowInterface is used by default
+    void setInterface(AbstractInterface *interface);
+
+    //the applet under the point in window coordinates, 0 if there isn't any
+    Plasma::Applet *appletAt(const QPoint &point);
+
     QRect maskArea() const;
     void setMaskArea(QRect area);
 
@@ -106,7 +212,14 @@ public:
 Q_SIGNALS:
     void childrenLengthChanged();
     void disableHidingChanged();
+    void hideDelayChanged();
+    void hoveredIndexChanged();
+    void hoveredItemChanged();
+    void hoveredOffsetChanged();
+    //the mouse has left the hovered item and hasn't entered another one
+    void hoverLeft();
     void immutableChanged();
+    void inputMaskOnlyChanged();
     void isAutoHiddenChanged();
     void isHoveredChanged();
     void locationChanged();
@@ -114,19 +227,39 @@ Q_SIGNALS:
     void maximumLengthChanged();
     void mustBeRaised(); //are used to triger the sliding animations from the qml part
     void mustBeLowered();
+    void normalStateChanged();
     void panelVisibilityChanged();
     void screenGeometryChanged();
     void windowInAttentionChanged();
 
+    //the mask area inputs
+    void alignmentChanged();
+    void contentsAnimatedChanged();
+    void contentsHoveredChanged();
+    void contentsLengthChanged();
+    void edgeSpacingChanged();
+    void lengthAnimatedChanged();
+    void thicknessAnimatedChanged();
+    void maskThicknessAutoHiddenChanged();
+    void maskThicknessMidChanged();
+    void maskThicknessNormalChanged();
+    void maskThicknessZoomChanged();
+    void zoomLengthIncreaseChanged();
+
 public slots:
     Q_INVOKABLE void addAppletItem(QObject *item);
     Q_INVOKABLE void initialize();
     Q_INVOKABLE void removeAppletItem(QObject *item);
+    Q_INVOKABLE void removeHoverItem(QQuickItem *item);
+    //the item can be hovered and it is at the index of the layouts
+    Q_INVOKABLE void setHoverItem(int index, QQuickItem *item);
     Q_INVOKABLE void setTransientThickness(unsigned int thickness);
     Q_INVOKABLE void showNormal();
     Q_INVOKABLE void showOnTop();
     Q_INVOKABLE void showOnBottom();
     Q_INVOKABLE void shrinkTransient();
+    //requests a new mask area for the next frame
+    Q_INVOKABLE void updateMaskArea();
     void setWindowInAttention(bool state);
 
 
@@ -139,46 +272,123 @@ protected:
 
 private Q_SLOTS:
     void activeWindowChanged();
+    void appletDestroyed(QObject *applet);
+    void appletItemDestroyed(QObject *item);
+    void applyMaskArea();
+    void appletParentChanged();
+    void invalidateAppletIndex();
+    void invalidateAppletOrder();
+    void rebuildAppletIndex();
+    void sortAppletIndex();
+    void clearContextMenus();
+    void dockStateChanged();
+    void lowerRequested();
+    void raiseRequested();
+    void requestUpdateState();
     void updateState();
     void initWindow();
     void menuAboutToHide();
     void setIsHovered(bool state);
     void screenChanged(QScreen *screen);
+    void updateInterfaceScreen();
     void updateVisibilityFlags();
     void updateWindowPosition();
 
 private:
+    //the state of the visibility state machine, see updateState
+    enum VisibilityState {
+        Raised = 0,
+        Lowered
+    };
+
+    //the actions that a context menu was built from
+    struct ContextMenu {
+        QPointer<QMenu> menu;
+        QList<QAction *> appletActions;
+        QList<QAction *> containmentActions;
+        //the visible containment actions, up to two
+        int containmentEntries;
+        QAction *removeAction;
+    };
+
+    //the ancestors of the applets must be connected again
+    bool m_appletTrackingDirty;
+    bool m_contentsAnimated;
+    bool m_contentsHovered;
     bool m_disableHiding;
     bool m_immutable;
+    bool m_inputMaskOnly;
     bool m_isAutoHidden;
     bool m_isHovered;
+    bool m_lengthAnimated;
+    bool m_maskDirty;
+    bool m_normalState;
     //second pass of the initialization
     bool m_secondInitPass;
+    bool m_thicknessAnimated;
     bool m_windowIsInAttention;
 
+    int m_alignment;
     int m_childrenLength;
+    int m_contentsLength;
+    //the contents length when the hovering started, before the zoom
+    int m_hoverContentsLength;
+    int m_edgeSpacing;
+    int m_hideDelay;
+    int m_hoveredIndex;
     int m_tempThickness;
+    int m_maskThicknessAutoHidden;
+    int m_maskThicknessMid;
+    int m_maskThicknessNormal;
+    int m_maskThicknessZoom;
+    qreal m_hoveredOffset;
+    qreal m_zoomLengthIncrease;
     unsigned int m_maximumLength;
 
     QPointer<Plasma::Containment> m_containment;
     QRect m_maskArea;
     QScreen *m_screen;
-    QList<PlasmaQuick::AppletQuickItem *> m_appletItems;
+    QList<QPointer<PlasmaQuick::AppletQuickItem> > m_appletItems;
+    AppletGeometryIndex m_appletIndex;
+    //the items that can be hovered by their index, they are kept in their own
+    //index, apart from the applets, because both are searched separately
+    QMap<int, QPointer<QQuickItem> > m_hoverItems;
+    AppletGeometryIndex m_hoverIndex;
+    QPointer<QQuickItem> m_hoveredItem;
+    //rebuilds the applet indexes when applets are shown, hidden or reparented
+    QTimer m_appletIndexTimer;
+    //sorts the applet indexes when the geometries have settled
+    QTimer m_appletOrderTimer;
+    QTimer m_hideTimer;
     QTimer m_initTimer;
     QTimer m_updateStateTimer;
     QWeakPointer<QMenu> m_contextMenu;
+    //the cached context menus of the applets, the containment one is under 0
+    QHash<Plasma::Applet *, ContextMenu> m_contextMenus;
 
     Qt::Orientations m_panelOrientation;
 
     Plasma::Types::Location m_location;
 
     PanelVisibility m_panelVisibility;
+    VisibilityState m_visibilityState;
 
     AbstractInterface *m_interface;
 
-    void addAppletActions(QMenu *desktopMenu, Plasma::Applet *applet, QEvent *event);
-    void addContainmentActions(QMenu *desktopMenu, QEvent *event);
+    void addAppletActions(QMenu *desktopMenu, const ContextMenu &actions);
+    QList<QAction *> appletActions(Plasma::Applet *applet) const;
+    QAction *appletRemoveAction(Plasma::Applet *applet) const;
+    QList<QAction *> containmentActions(Plasma::ContainmentActions *plugin) const;
+    Plasma::ContainmentActions *containmentActionsPlugin(const QString &trigger);
+    QMenu *contextMenu(Plasma::Applet *applet, Plasma::ContainmentActions *plugin);
+    void applyMask();
+    void setHovered(int index, QQuickItem *item, qreal offset);
+    void setNormalState(bool state);
+    VisibilityState nextState() const;
+    void setVisibilityState(VisibilityState state);
     void setPanelOrientation(Plasma::Types::Location location);
+    void trackAppletGeometry(QQuickItem *item);
+    void updateHovered(const QPointF &point);
     void updateMaximumLength();
 };
 
@@ -0,0 +1,466 @@
+#include "fakeinterface.h"
+
+#include "panelwindow.h"
+
+#include <QStringList>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace NowDock
+{
+
+const WId FakeInterface::DockId = WId(-1);
+
+static bool parseGeometry(const QString &text, QRect *geometry)
+{
+    QStringList values = text.split(QLatin1Char(','));
+
+    if (values.count() != 4) {
+        return false;
+    }
+
+    int coordinates[4];
+
+    for (int i=0; i<4; ++i) {
+        bool ok = false;
+        coordinates[i] = values.at(i).toInt(&ok);
+
+        if (!ok) {
+            return false;
+        }
+    }
+
+    *geometry = QRect(coordinates[0], coordinates[1], coordinates[2], coordinates[3]);
+
+    return geometry->isValid();
+}
+
+FakeInterface::FakeInterface(QQuickWindow *dock) :
+    AbstractInterface(dock),
+    m_activeWindow(0),
+    m_inAttention(false),
+    m_dockLayer(AboveLayer),
+    m_dockGeometry(0, 1000, 1920, 80),
+    m_screen(0, 0, 1920, 1080)
+{
+    //PanelWindow has already shown the dock on top when it is replaced
+    m_raiseOrder.append(DockId);
+}
+
+bool FakeInterface::activeIsMaximized() const
+{
+    QHash<WId, Window>::const_iterator it = m_windows.constFind(m_activeWindow);
+
+    return (it != m_windows.constEnd()) && it.value().maximized && !it.value().minimized;
+}
+
+bool FakeInterface::desktopIsActive() const
+{
+    return m_windows.value(m_activeWindow).desktop;
+}
+
+bool FakeInterface::dockIntersectsActiveWindow() const
+{
+    QHash<WId, Window>::const_iterator it = m_windows.constFind(m_activeWindow);
+
+    return (it != m_windows.constEnd()) && !it.value().minimized && it.value().geometry.intersects(m_dockGeometry);
+}
+
+bool FakeInterface::dockIsCovered() const
+{
+    QList<WId> windows = stackingOrder();
+
+    for (int i=windows.indexOf(DockId)+1; i<windows.count(); ++i) {
+        if (canCoverDock(windows.at(i))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool FakeInterface::dockIsCovering() const
+{
+    QList<WId> windows = stackingOrder();
+    int dock = windows.indexOf(DockId);
+
+    for (int i=0; i<dock; ++i) {
+        if (canCoverDock(windows.at(i))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool FakeInterface::dockIsOnTop() const
+{
+    return m_dockLayer == AboveLayer;
+}
+
+bool FakeInterface::dockInNormalState() const
+{
+    return m_dockLayer == NormalLayer;
+}
+
+bool FakeInterface::dockIsBelow() const
+{
+    return m_dockLayer == BelowLayer;
+}
+
+void FakeInterface::setDockToAllDesktops()
+{
+}
+
+void FakeInterface::setDockToAlwaysVisible()
+{
+}
+
+//the dock keeps its place among the windows of its new layer
+void FakeInterface::showDockAsNormal()
+{
+    setDockLayer(NormalLayer);
+}
+
+void FakeInterface::showDockOnBottom()
+{
+    setDockLayer(BelowLayer);
+}
+
+void FakeInterface::showDockOnTop()
+{
+    setDockLayer(AboveLayer);
+}
+
+void FakeInterface::setInputMask(QRect area)
+{
+    Q_UNUSED(area);
+}
+
+QRect FakeInterface::dockGeometry() const
+{
+    return m_dockGeometry;
+}
+
+void FakeInterface::setDockGeometry(const QRect &geometry)
+{
+    if (m_dockGeometry == geometry) {
+        return;
+    }
+
+    m_dockGeometry = geometry;
+
+    emit windowChanged();
+}
+
+FakeInterface::Layer FakeInterface::dockLayer() const
+{
+    return m_dockLayer;
+}
+
+void FakeInterface::setDockLayer(Layer layer)
+{
+    if (m_dockLayer == layer) {
+        return;
+    }
+
+    m_dockLayer = layer;
+
+    emit dockStateChanged();
+}
+
+void FakeInterface::addWindow(WId id, const QRect &geometry)
+{
+    if ((id == 0) || (id == DockId) || m_windows.contains(id)) {
+        return;
+    }
+
+    Window window;
+    window.geometry = geometry;
+
+    m_windows.insert(id, window);
+    m_raiseOrder.append(id);
+
+    emit windowChanged();
+}
+
+void FakeInterface::addDesktop(WId id)
+{
+    if ((id == 0) || (id == DockId) || m_windows.contains(id)) {
+        return;
+    }
+
+    Window window;
+    window.geometry = m_screen;
+    window.desktop = true;
+
+    m_windows.insert(id, window);
+    m_raiseOrder.append(id);
+
+    emit windowChanged();
+}
+
+void FakeInterface::removeWindow(WId id)
+{
+    if (!m_windows.remove(id)) {
+        return;
+    }
+
+    m_raiseOrder.removeAll(id);
+
+    updateAttention();
+
+    emit windowChanged();
+
+    if (m_activeWindow == id) {
+        m_activeWindow = 0;
+        emit activeWindowChanged();
+    }
+}
+
+void FakeInterface::activateWindow(WId id)
+{
+    if ((id != 0) && !m_windows.contains(id)) {
+        return;
+    }
+
+    if (id != 0) {
+        raiseWindow(id);
+    }
+
+    if (m_activeWindow == id) {
+        return;
+    }
+
+    m_activeWindow = id;
+
+    emit activeWindowChanged();
+}
+
+void FakeInterface::raiseWindow(WId id)
+{
+    if (!m_windows.contains(id) || (m_raiseOrder.last() == id)) {
+        return;
+    }
+
+    m_raiseOrder.removeAll(id);
+    m_raiseOrder.append(id);
+
+    emit windowChanged();
+}
+
+void FakeInterface::moveWindow(WId id, const QRect &geometry)
+{
+    QHash<WId, Window>::iterator it = m_windows.find(id);
+
+    if ((it == m_windows.end()) || (it.value().geometry == geometry)) {
+        return;
+    }
+
+    it.value().geometry = geometry;
+    it.value().maximized = false;
+
+    emit windowChanged();
+}
+
+void FakeInterface::setMaximized(WId id, bool maximized)
+{
+    QHash<WId, Window>::iterator it = m_windows.find(id);
+
+    if ((it == m_windows.end()) || it.value().desktop || (it.value().maximized == maximized)) {
+        return;
+    }
+
+    Window &window = it.value();
+    window.maximized = maximized;
+
+    if (maximized) {
+        window.restoreGeometry = window.geometry;
+        window.geometry = m_screen;
+    } else {
+        window.geometry = window.restoreGeometry;
+    }
+
+    emit windowChanged();
+}
+
+void FakeInterface::setMinimized(WId id, bool minimized)
+{
+    QHash<WId, Window>::iterator it = m_windows.find(id);
+
+    if ((it == m_windows.end()) || it.value().desktop || (it.value().minimized == minimized)) {
+        return;
+    }
+
+    it.value().minimized = minimized;
+
+    emit windowChanged();
+}
+
+void FakeInterface::setDemandsAttention(WId id, bool attention)
+{
+    QHash<WId, Window>::iterator it = m_windows.find(id);
+
+    if ((it == m_windows.end()) || (it.value().demandsAttention == attention)) {
+        return;
+    }
+
+    it.value().demandsAttention = attention;
+
+    updateAttention();
+}
+
+bool FakeInterface::apply(const QString &event)
+{
+    QStringList arguments = event.simplified().split(QLatin1Char(' '));
+    QString command = arguments.takeFirst();
+
+    if (arguments.isEmpty()) {
+        return false;
+    }
+
+    bool ok = false;
+    WId id = arguments.takeFirst().toULong(&ok);
+
+    if (!ok) {
+        return false;
+    }
+
+    QRect geometry;
+
+    if ((command == QLatin1String("window")) || (command == QLatin1String("move"))) {
+        if ((arguments.count() != 1) || !parseGeometry(arguments.first(), &geometry)) {
+            return false;
+        }
+
+        if (command == QLatin1String("window")) {
+            addWindow(id, geometry);
+        } else {
+            moveWindow(id, geometry);
+        }
+
+        return true;
+    }
+
+    if (command == QLatin1String("attention")) {
+        if ((arguments.count() != 1) || ((arguments.first() != QLatin1String("on")) && (arguments.first() != QLatin1String("off")))) {
+            return false;
+        }
+
+        setDemandsAttention(id, arguments.first() == QLatin1String("on"));
+        return true;
+    }
+
+    if (!arguments.isEmpty()) {
+        return false;
+    }
+
+    if (command == QLatin1String("desktop")) {
+        addDesktop(id);
+    } else if (command == QLatin1String("close")) {
+        removeWindow(id);
+    } else if (command == QLatin1String("activate")) {
+        activateWindow(id);
+    } else if (command == QLatin1String("raise")) {
+        raiseWindow(id);
+    } else if (command == QLatin1String("maximize")) {
+        setMaximized(id, true);
+    } else if (command == QLatin1String("restore")) {
+        setMaximized(id, false);
+    } else if (command == QLatin1String("minimize")) {
+        setMinimized(id, true);
+    } else if (command == QLatin1String("unminimize")) {
+        setMinimized(id, false);
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * The dock is moved on the window system layers in the middle of the
+ * sliding animations, in the auto hide mode they only change isAutoHidden.
+ * With a delay the dock is moved that many ms after the request, like the
+ * real animations do.
+ */
+void FakeInterface::followSlidingAnimations(PanelWindow *dock, int delay)
+{
+    connect(dock, &PanelWindow::mustBeRaised, this, [dock, delay]() {
+        QTimer::singleShot(delay, dock, [dock]() {
+            if (dock->panelVisibility() == PanelWindow::AutoHide) {
+                dock->setIsAutoHidden(false);
+            } else {
+                dock->showOnTop();
+            }
+        });
+    });
+
+    connect(dock, &PanelWindow::mustBeLowered, this, [dock, delay]() {
+        QTimer::singleShot(delay, dock, [dock]() {
+            if (dock->panelVisibility() == PanelWindow::AutoHide) {
+                dock->setIsAutoHidden(true);
+            } else if (dock->panelVisibility() == PanelWindow::LetWindowsCover) {
+                dock->showOnBottom();
+            } else {
+                dock->showNormal();
+            }
+        });
+    });
+}
+
+bool FakeInterface::canCoverDock(WId id) const
+{
+    QHash<WId, Window>::const_iterator it = m_windows.constFind(id);
+
+    if (it == m_windows.constEnd()) {
+        return false;
+    }
+
+    const Window &window = it.value();
+
+    return !window.desktop && !window.minimized && window.geometry.intersects(m_dockGeometry);
+}
+
+int FakeInterface::layer(WId id) const
+{
+    if (id == DockId) {
+        return m_dockLayer;
+    }
+
+    return m_windows.value(id).desktop ? DesktopLayer : NormalLayer;
+}
+
+QList<WId> FakeInterface::stackingOrder() const
+{
+    QList<WId> windows = m_raiseOrder;
+
+    std::stable_sort(windows.begin(), windows.end(), [this](WId a, WId b) {
+        return layer(a) < layer(b);
+    });
+
+    return windows;
+}
+
+void FakeInterface::updateAttention()
+{
+    bool inAttention = false;
+
+    foreach (const Window &window, m_windows) {
+        if (window.demandsAttention) {
+            inAttention = true;
+            break;
+        }
+    }
+
+    if (m_inAttention == inAttention) {
+        return;
+    }
+
+    m_inAttention = inAttention;
+
+    emit windowInAttention(inAttention);
+}
+
+}
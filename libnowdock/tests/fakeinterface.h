@@ -0,0 +1,128 @@
+#ifndef FAKEINTERFACE_H
+#define FAKEINTERFACE_H
+
+#include <QHash>
+#include <QList>
+#include <QRect>
+#include <QString>
+
+#include "abstractinterface.h"
+
+namespace NowDock
+{
+
+class PanelWindow;
+
+/*
+ * An in-process window system for the tests. It has its own 1920x1080
+ * screen with the dock on its bottom edge, the geometry of the real dock
+ * window is not used. The windows are stacked in layers, desktops below
+ * everything and the dock on the layer that it has been shown on, and a
+ * window that is raised or activated goes on top of its layer.
+ *
+ * The windows are changed from the tests or from the lines of a trace:
+ *
+ *     window <id> <x>,<y>,<width>,<height>
+ *     desktop <id>
+ *     close <id>
+ *     activate <id>           0 for no active window
+ *     raise <id>
+ *     move <id> <x>,<y>,<width>,<height>
+ *     maximize <id> / restore <id>
+ *     minimize <id> / unminimize <id>
+ *     attention <id> on|off
+ */
+class FakeInterface : public AbstractInterface {
+    Q_OBJECT
+
+public:
+    enum Layer {
+        DesktopLayer = -2,
+        BelowLayer,
+        NormalLayer,
+        AboveLayer
+    };
+
+    explicit FakeInterface(QQuickWindow *dock);
+
+    bool activeIsMaximized() const;
+    bool desktopIsActive() const;
+    bool dockIntersectsActiveWindow() const;
+    bool dockIsCovered() const;
+    bool dockIsCovering() const;
+    bool dockIsOnTop() const;
+    bool dockInNormalState() const;
+    bool dockIsBelow() const;
+
+    void setDockToAllDesktops();
+    void setDockToAlwaysVisible();
+    void showDockAsNormal();
+    void showDockOnBottom();
+    void showDockOnTop();
+
+    void setInputMask(QRect area);
+
+    QRect dockGeometry() const;
+    void setDockGeometry(const QRect &geometry);
+
+    Layer dockLayer() const;
+
+    void addWindow(WId id, const QRect &geometry);
+    void addDesktop(WId id);
+    void removeWindow(WId id);
+    void activateWindow(WId id);
+    void raiseWindow(WId id);
+    void moveWindow(WId id, const QRect &geometry);
+    void setMaximized(WId id, bool maximized);
+    void setMinimized(WId id, bool minimized);
+    void setDemandsAttention(WId id, bool attention);
+
+    //applies a line of a trace, false if it isn't a valid window event
+    bool apply(const QString &event);
+
+    //does what MagicWindow.qml does when the dock has slided in or out
+    void followSlidingAnimations(PanelWindow *dock, int delay = 0);
+
+private:
+    struct Window {
+        Window() :
+            desktop(false),
+            maximized(false),
+            minimized(false),
+            demandsAttention(false)
+        {
+        }
+
+        QRect geometry;
+        //the geometry before the window was maximized
+        QRect restoreGeometry;
+        bool desktop;
+        bool maximized;
+        bool minimized;
+        bool demandsAttention;
+    };
+
+    //the place of the dock among the windows
+    static const WId DockId;
+
+    WId m_activeWindow;
+    bool m_inAttention;
+
+    Layer m_dockLayer;
+    QRect m_dockGeometry;
+    QRect m_screen;
+
+    QHash<WId, Window> m_windows;
+    //bottom to top, the layers are applied on top of it
+    QList<WId> m_raiseOrder;
+
+    bool canCoverDock(WId id) const;
+    int layer(WId id) const;
+    void setDockLayer(Layer layer);
+    QList<WId> stackingOrder() const;
+    void updateAttention();
+};
+
+}
+
+#endif
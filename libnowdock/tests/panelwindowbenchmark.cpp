@@ -0,0 +1,70 @@
+#include "fakeinterface.h"
+#include "panelwindow.h"
+
+#include <QtTest>
+
+using namespace NowDock;
+
+/*
+ * Measures the decisions of the visibility state machine of PanelWindow.
+ * Every iteration is a single decision: a window asks for attention or
+ * stops asking for it and the state is evaluated once for the change,
+ * so the decisions per second are the inverse of the time per iteration.
+ */
+class PanelWindowBenchmark : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void decisions_data();
+    void decisions();
+};
+
+void PanelWindowBenchmark::decisions_data()
+{
+    QTest::addColumn<int>("visibility");
+
+    QTest::newRow("BelowActive") << int(PanelWindow::BelowActive);
+    QTest::newRow("BelowMaximized") << int(PanelWindow::BelowMaximized);
+    QTest::newRow("LetWindowsCover") << int(PanelWindow::LetWindowsCover);
+    QTest::newRow("WindowsGoBelow") << int(PanelWindow::WindowsGoBelow);
+    QTest::newRow("AutoHide") << int(PanelWindow::AutoHide);
+    QTest::newRow("AlwaysVisible") << int(PanelWindow::AlwaysVisible);
+}
+
+void PanelWindowBenchmark::decisions()
+{
+    QFETCH(int, visibility);
+
+    PanelWindow window;
+    window.setHideDelay(0);
+
+    FakeInterface *interface = new FakeInterface(&window);
+    interface->followSlidingAnimations(&window);
+
+    window.setInterface(interface);
+    window.setPanelVisibility(static_cast<PanelWindow::PanelVisibility>(visibility));
+
+    //a busy session, the active window is maximized over the dock
+    for (WId id=1; id<=50; ++id) {
+        interface->addWindow(id, QRect(20 * id, 10 * id, 800, 600));
+    }
+
+    interface->activateWindow(1);
+    interface->setMaximized(1, true);
+
+    QTest::qWait(5);
+
+    bool attention = false;
+
+    QBENCHMARK {
+        attention = !attention;
+        interface->setDemandsAttention(2, attention);
+
+        //the state timer runs without delay
+        QCoreApplication::processEvents();
+    }
+}
+
+QTEST_MAIN(PanelWindowBenchmark)
+
+#include "panelwindowbenchmark.moc"
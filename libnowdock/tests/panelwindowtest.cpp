@@ -0,0 +1,191 @@
+#include "fakeinterface.h"
+#include "panelwindow.h"
+
+#include <QEnterEvent>
+#include <QFile>
+#include <QTextStream>
+#include <QtTest>
+
+using namespace NowDock;
+
+/*
+ * Replays the window event traces of the traces directory against the
+ * visibility state machine of PanelWindow in every visibility mode and
+ * checks the raise and lower requests that it sends. Besides the window
+ * events a trace can contain "enter" and "leave" for the mouse on the dock.
+ * The traces are written by hand for the visibility rules, they are not
+ * recorded sessions. The other tests check the requests while the layer
+ * of the dock changes.
+ */
+class PanelWindowTest : public QObject {
+    Q_OBJECT
+
+public:
+    PanelWindowTest();
+
+private Q_SLOTS:
+    void cleanup();
+
+    void replay_data();
+    void replay();
+
+    void requestsDuringAnimation();
+    void lateLayerChange();
+
+private:
+    PanelWindow *m_window;
+    FakeInterface *m_interface;
+    QStringList m_requests;
+
+    void addRows(const QString &trace, const QStringList &expected);
+    void createDock(PanelWindow::PanelVisibility visibility, int slidingDelay = 0);
+    void settle();
+};
+
+static const char *const VisibilityNames[] = {
+    "BelowActive",
+    "BelowMaximized",
+    "LetWindowsCover",
+    "WindowsGoBelow",
+    "AutoHide",
+    "AlwaysVisible"
+};
+
+PanelWindowTest::PanelWindowTest() :
+    m_window(0),
+    m_interface(0)
+{
+}
+
+void PanelWindowTest::cleanup()
+{
+    delete m_window;
+    m_window = 0;
+    m_interface = 0;
+
+    m_requests.clear();
+}
+
+//expected: the requests of the trace for every visibility mode in the order of the enum
+void PanelWindowTest::addRows(const QString &trace, const QStringList &expected)
+{
+    for (int i=0; i<expected.count(); ++i) {
+        QTest::newRow(qPrintable(trace + QLatin1Char('/') + VisibilityNames[i])) << trace << i << expected.at(i);
+    }
+}
+
+void PanelWindowTest::replay_data()
+{
+    QTest::addColumn<QString>("trace");
+    QTest::addColumn<int>("visibility");
+    QTest::addColumn<QString>("expected");
+
+    addRows("maximized-window", {"lower", "lower", "", "", "", ""});
+    addRows("covering-window", {"lower raise", "", "", "", "", ""});
+    addRows("attention", {"lower raise lower", "lower raise lower", "raise lower", "", "raise lower", ""});
+    addRows("hover", {"lower lower", "lower lower", "lower", "", "raise lower", ""});
+    addRows("desktop", {"lower raise", "", "", "", "", ""});
+}
+
+void PanelWindowTest::replay()
+{
+    QFETCH(QString, trace);
+    QFETCH(int, visibility);
+    QFETCH(QString, expected);
+
+    QFile file(QFINDTESTDATA("traces/" + trace + ".trace"));
+    QVERIFY2(file.open(QIODevice::ReadOnly | QIODevice::Text), qPrintable(file.fileName()));
+
+    createDock(static_cast<PanelWindow::PanelVisibility>(visibility));
+
+    QTextStream stream(&file);
+
+    while (!stream.atEnd()) {
+        QString event = stream.readLine().section(QLatin1Char('#'), 0, 0).trimmed();
+
+        if (event.isEmpty()) {
+            continue;
+        }
+
+        if (event == QLatin1String("enter")) {
+            QEnterEvent enter(QPointF(10, 10), QPointF(10, 10), QPointF(10, 10));
+            QCoreApplication::sendEvent(m_window, &enter);
+        } else if (event == QLatin1String("leave")) {
+            QEvent leave(QEvent::Leave);
+            QCoreApplication::sendEvent(m_window, &leave);
+        } else {
+            QVERIFY2(m_interface->apply(event), qPrintable("invalid event: " + event));
+        }
+
+        settle();
+    }
+
+    QCOMPARE(m_requests.join(QLatin1Char(' ')), expected);
+}
+
+//the dock is still on top while it slides out, the window changes of that time don't lower it again
+void PanelWindowTest::requestsDuringAnimation()
+{
+    createDock(PanelWindow::BelowActive, 50);
+
+    m_interface->addWindow(2, QRect(0, 0, 1920, 1080));
+    m_interface->activateWindow(2);
+    settle();
+
+    m_interface->addWindow(3, QRect(100, 100, 400, 300));
+    settle();
+    m_interface->moveWindow(3, QRect(200, 100, 400, 300));
+    settle();
+
+    QTRY_COMPARE(m_interface->dockLayer(), FakeInterface::NormalLayer);
+    settle();
+
+    QCOMPARE(m_requests.join(QLatin1Char(' ')), QStringLiteral("lower"));
+}
+
+//a sliding animation that was requested before the last raise has finished late
+void PanelWindowTest::lateLayerChange()
+{
+    createDock(PanelWindow::BelowActive);
+
+    m_interface->showDockAsNormal();
+    settle();
+
+    QCOMPARE(m_interface->dockLayer(), FakeInterface::AboveLayer);
+    QVERIFY(m_requests.isEmpty());
+}
+
+/*
+ * The dock starts on top without any windows, the requests that it sends
+ * for its initial state are not part of the trace.
+ */
+void PanelWindowTest::createDock(PanelWindow::PanelVisibility visibility, int slidingDelay)
+{
+    m_window = new PanelWindow;
+    m_window->setHideDelay(0);
+
+    m_interface = new FakeInterface(m_window);
+    m_interface->followSlidingAnimations(m_window, slidingDelay);
+
+    m_window->setInterface(m_interface);
+    m_window->setPanelVisibility(visibility);
+
+    settle();
+
+    connect(m_window, &PanelWindow::mustBeRaised, this, [this]() {
+        m_requests.append(QStringLiteral("raise"));
+    });
+    connect(m_window, &PanelWindow::mustBeLowered, this, [this]() {
+        m_requests.append(QStringLiteral("lower"));
+    });
+}
+
+//the state and the hide timers run without delay in the tests
+void PanelWindowTest::settle()
+{
+    QTest::qWait(5);
+}
+
+QTEST_MAIN(PanelWindowTest)
+
+#include "panelwindowtest.moc"
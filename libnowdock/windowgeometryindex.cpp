@@ -0,0 +1,207 @@
+#include "windowgeometryindex.h"
+
+namespace NowDock
+{
+
+//the length in pixels that each bucket covers
+static const int BucketLength = 128;
+
+WindowGeometryIndex::WindowGeometryIndex(Qt::Orientation orientation) :
+    m_orientation(orientation)
+{
+}
+
+Qt::Orientation WindowGeometryIndex::orientation() const
+{
+    return m_orientation;
+}
+
+void WindowGeometryIndex::setOrientation(Qt::Orientation orientation)
+{
+    if (m_orientation == orientation) {
+        return;
+    }
+
+    m_orientation = orientation;
+
+    m_buckets.clear();
+
+    QHash<WId, Entry>::const_iterator it;
+
+    for (it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        addToBuckets(it.key(), it.value().geometry);
+    }
+}
+
+bool WindowGeometryIndex::contains(WId id) const
+{
+    return m_entries.contains(id);
+}
+
+QRect WindowGeometryIndex::geometry(WId id) const
+{
+    QHash<WId, Entry>::const_iterator it = m_entries.constFind(id);
+
+    return (it != m_entries.constEnd()) ? it.value().geometry : QRect();
+}
+
+void WindowGeometryIndex::clear()
+{
+    m_entries.clear();
+    m_buckets.clear();
+}
+
+void WindowGeometryIndex::insert(WId id, const QRect &geometry)
+{
+    QHash<WId, Entry>::iterator it = m_entries.find(id);
+
+    if (it != m_entries.end()) {
+        if (it.value().geometry == geometry) {
+            return;
+        }
+
+        removeFromBuckets(id, it.value().geometry);
+        it.value().geometry = geometry;
+    } else {
+        Entry entry;
+        entry.geometry = geometry;
+        entry.position = -1;
+
+        m_entries.insert(id, entry);
+    }
+
+    addToBuckets(id, geometry);
+}
+
+void WindowGeometryIndex::remove(WId id)
+{
+    QHash<WId, Entry>::iterator it = m_entries.find(id);
+
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    removeFromBuckets(id, it.value().geometry);
+    m_entries.erase(it);
+}
+
+void WindowGeometryIndex::setStackingPositions(const QHash<WId, int> &positions)
+{
+    QHash<WId, Entry>::iterator it;
+
+    for (it = m_entries.begin(); it != m_entries.end(); ++it) {
+        it.value().position = positions.value(it.key(), -1);
+    }
+}
+
+bool WindowGeometryIndex::intersectsAbove(const QRect &rect, int position, WId ignore) const
+{
+    return search(rect, Above, position, ignore);
+}
+
+bool WindowGeometryIndex::intersectsBelow(const QRect &rect, int position, WId ignore) const
+{
+    return search(rect, Below, position, ignore);
+}
+
+int WindowGeometryIndex::bucket(int coordinate) const
+{
+    //round towards negative infinity, windows can be placed on negative coordinates
+    return (coordinate >= 0) ? (coordinate / BucketLength) : ((coordinate + 1) / BucketLength - 1);
+}
+
+int WindowGeometryIndex::firstBucket(const QRect &rect) const
+{
+    return bucket(m_orientation == Qt::Horizontal ? rect.top() : rect.left());
+}
+
+int WindowGeometryIndex::lastBucket(const QRect &rect) const
+{
+    return bucket(m_orientation == Qt::Horizontal ? rect.bottom() : rect.right());
+}
+
+bool WindowGeometryIndex::search(const QRect &rect, Direction direction, int position, WId ignore) const
+{
+    if (!rect.isValid() || m_entries.isEmpty()) {
+        return false;
+    }
+
+    int first = firstBucket(rect);
+    int last = lastBucket(rect);
+
+    for (int b=first; b<=last; ++b) {
+        QHash<int, QVector<WId> >::const_iterator bIt = m_buckets.constFind(b);
+
+        if (bIt == m_buckets.constEnd()) {
+            continue;
+        }
+
+        foreach (WId id, bIt.value()) {
+            QHash<WId, Entry>::const_iterator it = m_entries.constFind(id);
+
+            if (it == m_entries.constEnd()) {
+                continue;
+            }
+
+            const Entry &entry = it.value();
+
+            //a window is spread in many buckets, it is checked only
+            //in the first one that is shared with the rect
+            if (qMax(firstBucket(entry.geometry), first) != b) {
+                continue;
+            }
+
+            if (id == ignore || !rect.intersects(entry.geometry)) {
+                continue;
+            }
+
+            if (direction == Above && (entry.position < 0 || entry.position <= position)) {
+                continue;
+            } else if (direction == Below && (entry.position < 0 || entry.position >= position)) {
+                continue;
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WindowGeometryIndex::addToBuckets(WId id, const QRect &geometry)
+{
+    if (!geometry.isValid()) {
+        return;
+    }
+
+    int last = lastBucket(geometry);
+
+    for (int b=firstBucket(geometry); b<=last; ++b) {
+        m_buckets[b].append(id);
+    }
+}
+
+void WindowGeometryIndex::removeFromBuckets(WId id, const QRect &geometry)
+{
+    if (!geometry.isValid()) {
+        return;
+    }
+
+    int last = lastBucket(geometry);
+
+    for (int b=firstBucket(geometry); b<=last; ++b) {
+        QHash<int, QVector<WId> >::iterator bIt = m_buckets.find(b);
+
+        if (bIt == m_buckets.end()) {
+            continue;
+        }
+
+        bIt.value().removeOne(id);
+
+        if (bIt.value().isEmpty()) {
+            m_buckets.erase(bIt);
+        }
+    }
+}
+
+}
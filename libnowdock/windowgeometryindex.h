@@ -0,0 +1,69 @@
+#ifndef WINDOWGEOMETRYINDEX_H
+#define WINDOWGEOMETRYINDEX_H
+
+#include <QHash>
+#include <QRect>
+#include <QVector>
+#include <QWindow>
+
+namespace NowDock
+{
+
+/*
+ * Spatial index for the windows geometries. The dock is always placed
+ * on a screen edge, so the windows are bucketed based on their interval
+ * on the axis that is vertical to that edge, e.g. for a bottom dock only
+ * the windows that reach the bottom of the screen are checked.
+ */
+class WindowGeometryIndex {
+public:
+    explicit WindowGeometryIndex(Qt::Orientation orientation = Qt::Horizontal);
+
+    Qt::Orientation orientation() const;
+    void setOrientation(Qt::Orientation orientation);
+
+    bool contains(WId id) const;
+
+    QRect geometry(WId id) const;
+
+    void clear();
+    void insert(WId id, const QRect &geometry);
+    void remove(WId id);
+
+    //positions are the indexes of the windows in the stacking order, bottom to top,
+    //only the windows of the index are looked up in them
+    void setStackingPositions(const QHash<WId, int> &positions);
+
+    //is there any window that intersects the rect and is above/below the given stacking position
+    bool intersectsAbove(const QRect &rect, int position, WId ignore = 0) const;
+    bool intersectsBelow(const QRect &rect, int position, WId ignore = 0) const;
+
+private:
+    struct Entry {
+        QRect geometry;
+        int position;
+    };
+
+    enum Direction {
+        Above = 0,
+        Below
+    };
+
+    Qt::Orientation m_orientation;
+
+    QHash<WId, Entry> m_entries;
+    QHash<int, QVector<WId> > m_buckets;
+
+    int bucket(int coordinate) const;
+    int firstBucket(const QRect &rect) const;
+    int lastBucket(const QRect &rect) const;
+
+    bool search(const QRect &rect, Direction direction, int position, WId ignore) const;
+
+    void addToBuckets(WId id, const QRect &geometry);
+    void removeFromBuckets(WId id, const QRect &geometry);
+};
+
+}
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef WINDOWINFO_H
+#define WINDOWINFO_H
+
+#include <QRect>
+
+#include <KWindowInfo>
+
+namespace NowDock
+{
+
+/*
+ * A small copy of the window properties that the dock is interested in,
+ * it is filled once and afterwards it is updated only from the window
+ * system signals, so reading it doesn't need a roundtrip to the X server
+ */
+class WindowInfo {
+public:
+    WindowInfo() :
+        m_valid(false),
+        m_minimized(false),
+        m_type(NET::Unknown)
+    {
+    }
+
+    explicit WindowInfo(const KWindowInfo &info) :
+        m_valid(info.valid()),
+        m_minimized(false),
+        m_type(NET::Unknown)
+    {
+        if (m_valid) {
+            m_minimized = info.isMinimized();
+            m_state = info.state();
+            m_type = info.windowType(NET::DesktopMask|NET::DockMask|NET::DialogMask);
+            m_geometry = info.geometry();
+        }
+    }
+
+    WindowInfo(const QRect &geometry, NET::States state, NET::WindowType type, bool minimized) :
+        m_valid(true),
+        m_minimized(minimized),
+        m_state(state),
+        m_type(type),
+        m_geometry(geometry)
+    {
+    }
+
+    bool isValid() const { return m_valid; }
+    bool isDesktop() const { return m_valid && (m_type == NET::Desktop); }
+    bool isMinimized() const { return m_valid && m_minimized; }
+    bool isMaximized() const { return hasState(NET::Max); }
+    bool isOnTop() const { return hasState(NET::KeepAbove); }
+    bool isOnBottom() const { return hasState(NET::KeepBelow); }
+    bool demandsAttention() const { return hasState(NET::DemandsAttention); }
+
+    bool hasState(NET::States state) const { return m_valid && ((m_state & state) == state); }
+
+    bool operator==(const WindowInfo &other) const
+    {
+        return (m_valid == other.m_valid) && (m_minimized == other.m_minimized) && (m_state == other.m_state)
+               && (m_type == other.m_type) && (m_geometry == other.m_geometry);
+    }
+
+    bool operator!=(const WindowInfo &other) const { return !(*this == other); }
+
+    NET::States state() const { return m_state; }
+    NET::WindowType windowType() const { return m_type; }
+    QRect geometry() const { return m_geometry; }
+
+private:
+    bool m_valid;
+    bool m_minimized;
+
+    NET::States m_state;
+    NET::WindowType m_type;
+
+    QRect m_geometry;
+};
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef WINDOWSNAPSHOT_H
+#define WINDOWSNAPSHOT_H
+
+#include <QHash>
+#include <QList>
+#include <QWindow>
+
+#include "windowinfo.h"
+
+namespace NowDock
+{
+
+/*
+ * The state of the windows at one moment. A snapshot is never changed
+ * after it has been published, a new one is published instead, so it can
+ * be read from any thread without locking.
+ */
+struct WindowSnapshot {
+    WindowSnapshot() :
+        activeWindow(0)
+    {
+    }
+
+    WId activeWindow;
+    //bottom to top
+    QList<WId> stackingOrder;
+    QHash<WId, int> stackingPositions;
+    QHash<WId, WindowInfo> windows;
+};
+
+}
+
+#endif
@@ -0,0 +1,200 @@
+#include "xwindowinfofetcher.h"
+
+#include <cstring>
+
+#include <QScopedPointer>
+#include <QVector>
+#include <QX11Info>
+
+namespace NowDock
+{
+
+static const char *atomNames[] = {
+    "WM_STATE",
+    "_NET_WM_STATE",
+    "_NET_WM_WINDOW_TYPE",
+    "_NET_WM_STATE_MAXIMIZED_VERT",
+    "_NET_WM_STATE_MAXIMIZED_HORZ",
+    "_NET_WM_STATE_ABOVE",
+    "_NET_WM_STATE_BELOW",
+    "_NET_WM_STATE_HIDDEN",
+    "_NET_WM_STATE_SHADED",
+    "_NET_WM_STATE_DEMANDS_ATTENTION",
+    "_NET_WM_WINDOW_TYPE_DESKTOP",
+    "_NET_WM_WINDOW_TYPE_DOCK",
+    "_NET_WM_WINDOW_TYPE_DIALOG"
+};
+
+//ICCCM IconicState
+static const uint32_t IconicState = 3;
+
+template <typename T>
+using XcbReply = QScopedPointer<T, QScopedPointerPodDeleter>;
+
+XWindowInfoFetcher::XWindowInfoFetcher() :
+    m_connection(0),
+    m_rootWindow(XCB_WINDOW_NONE)
+{
+    for (int i=0; i<AtomsCount; ++i) {
+        m_atoms[i] = XCB_ATOM_NONE;
+    }
+
+    if (QX11Info::isPlatformX11()) {
+        init(QX11Info::connection(), QX11Info::appRootWindow());
+    }
+}
+
+XWindowInfoFetcher::XWindowInfoFetcher(xcb_connection_t *connection, xcb_window_t rootWindow) :
+    m_connection(0),
+    m_rootWindow(XCB_WINDOW_NONE)
+{
+    for (int i=0; i<AtomsCount; ++i) {
+        m_atoms[i] = XCB_ATOM_NONE;
+    }
+
+    if (connection) {
+        init(connection, rootWindow);
+    }
+}
+
+void XWindowInfoFetcher::init(xcb_connection_t *connection, xcb_window_t rootWindow)
+{
+    m_connection = connection;
+    m_rootWindow = rootWindow;
+
+    //the atoms are interned also in a single roundtrip
+    xcb_intern_atom_cookie_t cookies[AtomsCount];
+
+    for (int i=0; i<AtomsCount; ++i) {
+        cookies[i] = xcb_intern_atom(m_connection, false, strlen(atomNames[i]), atomNames[i]);
+    }
+
+    for (int i=0; i<AtomsCount; ++i) {
+        XcbReply<xcb_intern_atom_reply_t> reply(xcb_intern_atom_reply(m_connection, cookies[i], 0));
+
+        if (reply) {
+            m_atoms[i] = reply->atom;
+        }
+    }
+}
+
+bool XWindowInfoFetcher::isValid() const
+{
+    return m_connection != 0;
+}
+
+QHash<WId, WindowInfo> XWindowInfoFetcher::fetch(const QList<WId> &windows) const
+{
+    QHash<WId, WindowInfo> result;
+
+    if (!isValid() || windows.isEmpty()) {
+        return result;
+    }
+
+    int count = windows.count();
+
+    QVector<xcb_get_property_cookie_t> wmStateCookies(count);
+    QVector<xcb_get_property_cookie_t> stateCookies(count);
+    QVector<xcb_get_property_cookie_t> typeCookies(count);
+    QVector<xcb_get_geometry_cookie_t> geometryCookies(count);
+    QVector<xcb_translate_coordinates_cookie_t> positionCookies(count);
+
+    //first pass, send all the requests
+    for (int i=0; i<count; ++i) {
+        xcb_window_t window = windows.at(i);
+
+        wmStateCookies[i] = xcb_get_property(m_connection, false, window, m_atoms[WmState], m_atoms[WmState], 0, 2);
+        stateCookies[i] = xcb_get_property(m_connection, false, window, m_atoms[NetWmState], XCB_ATOM_ATOM, 0, 2048);
+        typeCookies[i] = xcb_get_property(m_connection, false, window, m_atoms[NetWmWindowType], XCB_ATOM_ATOM, 0, 2048);
+        geometryCookies[i] = xcb_get_geometry(m_connection, window);
+        positionCookies[i] = xcb_translate_coordinates(m_connection, window, m_rootWindow, 0, 0);
+    }
+
+    //second pass, collect the replies
+    for (int i=0; i<count; ++i) {
+        XcbReply<xcb_get_property_reply_t> wmStateReply(xcb_get_property_reply(m_connection, wmStateCookies[i], 0));
+        XcbReply<xcb_get_property_reply_t> stateReply(xcb_get_property_reply(m_connection, stateCookies[i], 0));
+        XcbReply<xcb_get_property_reply_t> typeReply(xcb_get_property_reply(m_connection, typeCookies[i], 0));
+        XcbReply<xcb_get_geometry_reply_t> geometryReply(xcb_get_geometry_reply(m_connection, geometryCookies[i], 0));
+        XcbReply<xcb_translate_coordinates_reply_t> positionReply(xcb_translate_coordinates_reply(m_connection, positionCookies[i], 0));
+
+        //the window has been destroyed in the meantime
+        if (!geometryReply || !positionReply) {
+            continue;
+        }
+
+        NET::States state;
+        NET::WindowType type = NET::Unknown;
+        bool iconic = false;
+
+        if (stateReply && stateReply->format == 32) {
+            state = states(static_cast<xcb_atom_t *>(xcb_get_property_value(stateReply.data())),
+                           xcb_get_property_value_length(stateReply.data()) / sizeof(xcb_atom_t));
+        }
+
+        if (typeReply && typeReply->format == 32) {
+            type = windowType(static_cast<xcb_atom_t *>(xcb_get_property_value(typeReply.data())),
+                              xcb_get_property_value_length(typeReply.data()) / sizeof(xcb_atom_t));
+        }
+
+        if (wmStateReply && wmStateReply->format == 32 && xcb_get_property_value_length(wmStateReply.data()) >= 4) {
+            iconic = (*static_cast<uint32_t *>(xcb_get_property_value(wmStateReply.data())) == IconicState);
+        }
+
+        //same as KWindowInfo::isMinimized() for NETWM compliant window managers
+        bool minimized = iconic && state.testFlag(NET::Hidden) && !state.testFlag(NET::Shaded);
+
+        QRect geometry(positionReply->dst_x, positionReply->dst_y, geometryReply->width, geometryReply->height);
+
+        result.insert(windows.at(i), WindowInfo(geometry, state, type, minimized));
+    }
+
+    return result;
+}
+
+NET::States XWindowInfoFetcher::states(const xcb_atom_t *atoms, int count) const
+{
+    NET::States result;
+
+    for (int i=0; i<count; ++i) {
+        xcb_atom_t atom = atoms[i];
+
+        if (atom == m_atoms[StateMaxVert]) {
+            result |= NET::MaxVert;
+        } else if (atom == m_atoms[StateMaxHorz]) {
+            result |= NET::MaxHoriz;
+        } else if (atom == m_atoms[StateAbove]) {
+            result |= NET::KeepAbove;
+        } else if (atom == m_atoms[StateBelow]) {
+            result |= NET::KeepBelow;
+        } else if (atom == m_atoms[StateHidden]) {
+            result |= NET::Hidden;
+        } else if (atom == m_atoms[StateShaded]) {
+            result |= NET::Shaded;
+        } else if (atom == m_atoms[StateDemandsAttention]) {
+            result |= NET::DemandsAttention;
+        }
+    }
+
+    return result;
+}
+
+NET::WindowType XWindowInfoFetcher::windowType(const xcb_atom_t *atoms, int count) const
+{
+    //the types are ordered by preference, the first known one is used
+    for (int i=0; i<count; ++i) {
+        xcb_atom_t atom = atoms[i];
+
+        if (atom == m_atoms[TypeDesktop]) {
+            return NET::Desktop;
+        } else if (atom == m_atoms[TypeDock]) {
+            return NET::Dock;
+        } else if (atom == m_atoms[TypeDialog]) {
+            return NET::Dialog;
+        }
+    }
+
+    return NET::Unknown;
+}
+
+}
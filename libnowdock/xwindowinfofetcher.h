@@ -0,0 +1,64 @@
+#ifndef XWINDOWINFOFETCHER_H
+#define XWINDOWINFOFETCHER_H
+
+#include <QHash>
+#include <QList>
+#include <QWindow>
+
+#include <xcb/xcb.h>
+
+#include "windowinfo.h"
+
+namespace NowDock
+{
+
+/*
+ * Requests the windows properties that are needed from the dock for
+ * many windows at once. All the requests are sent in a single xcb
+ * pipeline and the replies are collected afterwards, in contrary with
+ * KWindowInfo that blocks for every window.
+ */
+class XWindowInfoFetcher {
+public:
+    //uses the connection of the application
+    XWindowInfoFetcher();
+    //e.g. the connection of another thread, it must be used only from that thread
+    XWindowInfoFetcher(xcb_connection_t *connection, xcb_window_t rootWindow);
+
+    bool isValid() const;
+
+    //windows that are not valid any more are not included in the result
+    QHash<WId, WindowInfo> fetch(const QList<WId> &windows) const;
+
+private:
+    enum Atom {
+        WmState = 0,
+        NetWmState,
+        NetWmWindowType,
+        StateMaxVert,
+        StateMaxHorz,
+        StateAbove,
+        StateBelow,
+        StateHidden,
+        StateShaded,
+        StateDemandsAttention,
+        TypeDesktop,
+        TypeDock,
+        TypeDialog,
+        AtomsCount
+    };
+
+    xcb_connection_t *m_connection;
+    xcb_window_t m_rootWindow;
+
+    xcb_atom_t m_atoms[AtomsCount];
+
+    void init(xcb_connection_t *connection, xcb_window_t rootWindow);
+
+    NET::States states(const xcb_atom_t *atoms, int count) const;
+    NET::WindowType windowType(const xcb_atom_t *atoms, int count) const;
+};
+
+}
+
+#endif
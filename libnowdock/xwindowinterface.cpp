@@ -1,26 +1,98 @@
 #include "xwindowinterface.h"
 
-#include <KWindowInfo>
+#include "instrumentation.h"
+
+#include <QScreen>
+#include <QX11Info>
+
 #include <KWindowSystem>
 
+#include <xcb/shape.h>
+
 namespace NowDock
 {
 
 XWindowInterface::XWindowInterface(QQuickWindow *parent) :
     AbstractInterface(parent),
-    m_demandsAttention(0)
+    m_demandsAttention(0),
+    m_dockState(0),
+    m_coverageDirty(true),
+    m_dockIsCovered(false),
+    m_dockIsCovering(false),
+    m_dockPosition(-1),
+    m_tracker(XWindowTracker::instance())
 {
-    m_activeWindow = KWindowSystem::activeWindow();
+    QScreen *screen = m_dockWindow->screen();
+    m_screenGeometry = screen ? screen->geometry() : QRect();
+
+    dockGeometryChanged();
+    updateIndexes();
 
-    connect(KWindowSystem::self(), SIGNAL(activeWindowChanged(WId)), this, SLOT(activeWindowChanged(WId)));
-    connect(KWindowSystem::self(), SIGNAL(windowChanged (WId,NET::Properties,NET::Properties2)), this, SLOT(windowChanged (WId,NET::Properties,NET::Properties2)));
-    connect(KWindowSystem::self(), SIGNAL(windowRemoved(WId)), this, SLOT(windowRemoved(WId)));
+    m_dockState = dockState();
+
+    connect(m_dockWindow, SIGNAL(xChanged(int)), this, SLOT(dockGeometryChanged()));
+    connect(m_dockWindow, SIGNAL(yChanged(int)), this, SLOT(dockGeometryChanged()));
+    connect(m_dockWindow, SIGNAL(widthChanged(int)), this, SLOT(dockGeometryChanged()));
+    connect(m_dockWindow, SIGNAL(heightChanged(int)), this, SLOT(dockGeometryChanged()));
+
+    connect(m_tracker.data(), &XWindowTracker::activeWindowChanged, this, &XWindowInterface::activeWindowChanged);
+    connect(m_tracker.data(), &XWindowTracker::windowsChanged, this, &XWindowInterface::windowsChanged);
 }
 
 XWindowInterface::~XWindowInterface()
 {
 }
 
+void XWindowInterface::setMaskArea(QRect area)
+{
+    if (m_maskArea == area) {
+        return;
+    }
+
+    AbstractInterface::setMaskArea(area);
+    dockGeometryChanged();
+}
+
+void XWindowInterface::setScreenGeometry(QRect geometry)
+{
+    if (m_screenGeometry == geometry) {
+        return;
+    }
+
+    AbstractInterface::setScreenGeometry(geometry);
+    updateIndexes();
+}
+
+void XWindowInterface::setInputMask(QRect area)
+{
+    if (!QX11Info::isPlatformX11()) {
+        return;
+    }
+
+    xcb_connection_t *connection = QX11Info::connection();
+    xcb_window_t window = m_dockWindow->winId();
+
+    if (area.isNull()) {
+        xcb_shape_mask(connection, XCB_SHAPE_SO_SET, XCB_SHAPE_SK_INPUT, window, 0, 0, XCB_PIXMAP_NONE);
+    } else {
+        //the area is in logical pixels and the X server uses device pixels
+        qreal ratio = m_dockWindow->devicePixelRatio();
+        QRect nativeArea = QRectF(area.x() * ratio, area.y() * ratio,
+                                  area.width() * ratio, area.height() * ratio).toAlignedRect();
+
+        xcb_rectangle_t rect;
+        rect.x = nativeArea.x();
+        rect.y = nativeArea.y();
+        rect.width = nativeArea.width();
+        rect.height = nativeArea.height();
+
+        xcb_shape_rectangles(connection, XCB_SHAPE_SO_SET, XCB_SHAPE_SK_INPUT, XCB_CLIP_ORDERING_UNSORTED,
+                             window, 0, 0, 1, &rect);
+    }
+
+    xcb_flush(connection);
+}
+
 void XWindowInterface::setDockToAllDesktops()
 {
     KWindowSystem::setOnAllDesktops(m_dockWindow->winId(), true);
@@ -52,28 +124,107 @@ void XWindowInterface::showDockOnBottom()
 }
 
 
-bool XWindowInterface::isDesktop(WId id) const
+QRect XWindowInterface::dockGeometry() const
+{
+    if ( !m_maskArea.isNull() ) {
+        return QRect(m_dockWindow->x()+m_maskArea.x(), m_dockWindow->y()+m_maskArea.y(), m_maskArea.width(), m_maskArea.height());
+    } else {
+        return QRect(m_dockWindow->x(), m_dockWindow->y(), m_dockWindow->width(), m_dockWindow->height());
+    }
+}
+
+int XWindowInterface::dockState() const
 {
-    KWindowInfo info(id, NET::WMWindowType);
+    return isOnTop(m_dockWindow->winId()) ? 1 : (isOnBottom(m_dockWindow->winId()) ? -1 : 0);
+}
 
-    if ( !info.valid() ) {
+WId XWindowInterface::dockTransient() const
+{
+    return m_dockWindow->transientParent() ? m_dockWindow->transientParent()->winId() : 0;
+}
+
+bool XWindowInterface::canCoverDock(WId id, const WindowInfo &info) const
+{
+    if ( !info.isValid() || info.isDesktop() || info.isMinimized() || (id == m_dockWindow->winId()) ) {
         return false;
     }
 
-    NET::WindowType type = info.windowType(NET::DesktopMask|NET::DockMask|NET::DialogMask);
+    //a window that crosses screens is kept in the docks of all of them
+    return ( m_screenGeometry.isNull() || m_screenGeometry.intersects(info.geometry()) );
+}
+
+void XWindowInterface::updateIndex(WId id, const WindowInfo &info)
+{
+    QRect dockRect = dockGeometry();
+    //the answers must be recomputed only when a window that overlaps
+    //the dock, before or after the change, is involved
+    bool wasOverlapping = m_windowsIndex.contains(id) && dockRect.intersects(m_windowsIndex.geometry(id));
+
+    if (canCoverDock(id, info)) {
+        m_windowsIndex.insert(id, info.geometry());
 
-    return type == NET::Desktop;
+        if (wasOverlapping || dockRect.intersects(info.geometry())) {
+            m_coverageDirty = true;
+        }
+    } else {
+        m_windowsIndex.remove(id);
+
+        if (wasOverlapping) {
+            m_coverageDirty = true;
+        }
+    }
 }
 
+void XWindowInterface::updateAttention(WId id, const WindowInfo &info)
+{
+    if (!info.isValid()) {
+        //the window has been removed
+        if (id == m_demandsAttention) {
+            m_demandsAttention = 0;
+            emit windowInAttention(false);
+        }
 
-bool XWindowInterface::isMaximized(WId id) const
+        return;
+    }
+
+    if ((m_demandsAttention == 0) && info.demandsAttention()) {
+        m_demandsAttention = id;
+        emit windowInAttention(true);
+    } else if ((m_demandsAttention == id) && !info.demandsAttention()) {
+        m_demandsAttention = 0;
+        emit windowInAttention(false);
+    }
+}
+
+void XWindowInterface::updateCoverage() const
 {
-    KWindowInfo info(id, NET::WMState);
+    if (!m_coverageDirty) {
+        return;
+    }
 
-    if ( !info.valid() ) {
-        return false;
+    m_coverageDirty = false;
+    m_dockIsCovered = false;
+    m_dockIsCovering = false;
+
+    if (m_dockPosition < 0) {
+        return;
     }
-    return ( info.hasState(NET::Max) );
+
+    QRect dockRect = dockGeometry();
+    WId transient = dockTransient();
+
+    m_dockIsCovered = m_windowsIndex.intersectsAbove(dockRect, m_dockPosition, transient);
+    m_dockIsCovering = m_windowsIndex.intersectsBelow(dockRect, m_dockPosition, transient);
+}
+
+bool XWindowInterface::isDesktop(WId id) const
+{
+    return m_tracker->windowInfo(id).isDesktop();
+}
+
+bool XWindowInterface::isMaximized(WId id) const
+{
+    return m_tracker->windowInfo(id).isMaximized();
 }
 
 bool XWindowInterface::isNormal(WId id) const
@@ -83,35 +234,27 @@ bool XWindowInterface::isNormal(WId id) const
 
 bool XWindowInterface::isOnBottom(WId id) const
 {
-    KWindowInfo info(id, NET::WMState);
-
-    if ( !info.valid() ) {
-        return false;
-    }
-
-    return ( info.hasState(NET::KeepBelow) );
+    return m_tracker->windowInfo(id).isOnBottom();
 }
 
 bool XWindowInterface::isOnTop(WId id) const
 {
-    KWindowInfo info(id, NET::WMState);
-
-    if ( !info.valid() ) {
-        return false;
-    }
-
-    return ( info.hasState(NET::KeepAbove) );
+    return m_tracker->windowInfo(id).isOnTop();
 }
 
 bool XWindowInterface::activeIsMaximized() const
 {
-    return isMaximized(m_activeWindow);
+    Instrumentation::Scope scope(Instrumentation::ActiveIsMaximized);
+
+    return isMaximized(m_tracker->activeWindow());
 }
 
 
 bool XWindowInterface::desktopIsActive() const
 {
-    return isDesktop(m_activeWindow);
+    Instrumentation::Scope scope(Instrumentation::DesktopIsActive);
+
+    return isDesktop(m_tracker->activeWindow());
 }
 
 bool XWindowInterface::dockIsOnTop() const
@@ -132,18 +275,12 @@ bool XWindowInterface::dockIsBelow() const
 
 bool XWindowInterface::dockIntersectsActiveWindow() const
 {
-    KWindowInfo activeInfo(m_activeWindow, NET::WMGeometry);
+    Instrumentation::Scope scope(Instrumentation::DockIntersectsActiveWindow);
 
-    if ( activeInfo.valid() ) {
-        QRect maskSize;
+    WindowInfo activeInfo = m_tracker->windowInfo(m_tracker->activeWindow());
 
-        if ( !m_maskArea.isNull() ) {
-            maskSize = QRect(m_dockWindow->x()+m_maskArea.x(), m_dockWindow->y()+m_maskArea.y(), m_maskArea.width(), m_maskArea.height());
-        } else {
-            maskSize = QRect(m_dockWindow->x(), m_dockWindow->y(), m_dockWindow->width(), m_dockWindow->height());
-        }
-
-        return maskSize.intersects(activeInfo.geometry());
+    if ( activeInfo.isValid() ) {
+        return dockGeometry().intersects(activeInfo.geometry());
     } else {
         return false;
     }
@@ -152,129 +289,100 @@ bool XWindowInterface::dockIntersectsActiveWindow() const
 
 bool XWindowInterface::dockIsCovered() const
 {
-    int currentDockPos = -1;
-
-    QList<WId> windows = KWindowSystem::stackingOrder();
-    int size = windows.count();
-
-    for(int i=size-1; i>=0; --i) {
-        WId window = windows.at(i);
-        if (window == m_dockWindow->winId()) {
-            currentDockPos = i;
-            break;
-        }
-    }
+    Instrumentation::Scope scope(Instrumentation::DockIsCovered);
 
-    if (currentDockPos >=0) {
-        QRect maskSize;
+    updateCoverage();
 
-        if ( m_maskArea.isNull() ) {
-            maskSize = QRect(m_dockWindow->x()+m_maskArea.x(), m_dockWindow->y()+m_maskArea.y(), m_maskArea.width(), m_maskArea.height());
-        } else {
-            maskSize = QRect(m_dockWindow->x(), m_dockWindow->y(), m_dockWindow->width(), m_dockWindow->height());
-        }
+    return m_dockIsCovered;
+}
 
-        WId transient=0;
+bool XWindowInterface::dockIsCovering() const
+{
+    Instrumentation::Scope scope(Instrumentation::DockIsCovering);
 
-        if (m_dockWindow->transientParent()) {
-            transient = m_dockWindow->transientParent()->winId();
-        }
+    updateCoverage();
 
-        for(int j=size-1; j>currentDockPos; --j) {
-            WId window = windows.at(j);
+    return m_dockIsCovering;
+}
 
-            KWindowInfo info(window, NET::WMState | NET::XAWMState | NET::WMGeometry);
+/*
+ * SLOTS
+ */
 
-            if ( info.valid() && !isDesktop(window) && transient!=window && !info.isMinimized() && maskSize.intersects(info.geometry()) ) {
-                return true;
-            }
-        }
-    }
+void XWindowInterface::activeWindowChanged(WId win)
+{
+    Q_UNUSED(win);
 
-    return false;
+    emit AbstractInterface::activeWindowChanged();
 }
 
-bool XWindowInterface::dockIsCovering() const
+void XWindowInterface::dockGeometryChanged()
 {
-    int currentDockPos = -1;
+    QRect dockRect = dockGeometry();
 
-    QList<WId> windows = KWindowSystem::stackingOrder();
-    int size = windows.count();
-
-    for(int i=size-1; i>=0; --i) {
-        WId window = windows.at(i);
-        if (window == m_dockWindow->winId()) {
-            currentDockPos = i;
-            break;
-        }
-    }
+    m_windowsIndex.setOrientation(dockRect.width() >= dockRect.height() ? Qt::Horizontal : Qt::Vertical);
 
-    if (currentDockPos >=0) {
-        QRect maskSize;
+    m_coverageDirty = true;
+}
 
-        if ( !m_maskArea.isNull() ) {
-            maskSize = QRect(m_dockWindow->x()+m_maskArea.x(), m_dockWindow->y()+m_maskArea.y(), m_maskArea.width(), m_maskArea.height());
-        } else {
-            maskSize = QRect(m_dockWindow->x(), m_dockWindow->y(), m_dockWindow->width(), m_dockWindow->height());
-        }
+void XWindowInterface::updateIndexes()
+{
+    m_windowsIndex.clear();
 
-        WId transient=0;
+    foreach (WId id, m_tracker->windows()) {
+        WindowInfo info = m_tracker->windowInfo(id);
 
-        if (m_dockWindow->transientParent()) {
-            transient = m_dockWindow->transientParent()->winId();
+        if (canCoverDock(id, info)) {
+            m_windowsIndex.insert(id, info.geometry());
         }
+    }
 
-        for(int j=currentDockPos-1; j>=0; --j) {
-            WId window = windows.at(j);
+    updateStackingOrder();
+}
 
-            KWindowInfo info(window, NET::WMState | NET::XAWMState | NET::WMGeometry);
+void XWindowInterface::updateStackingOrder()
+{
+    QHash<WId, int> positions = m_tracker->stackingPositions();
 
-            if ( info.valid() && !isDesktop(window) && transient!=window && !info.isMinimized() && maskSize.intersects(info.geometry()) ) {
-                return true;
-            }
-        }
-    }
+    m_windowsIndex.setStackingPositions(positions);
+    m_dockPosition = positions.value(m_dockWindow->winId(), -1);
 
-    return false;
+    m_coverageDirty = true;
 }
 
 /*
- * SLOTS
+ * The tracker has already fetched the windows, only the index of the
+ * dock is updated and the dock is notified when its answers change.
  */
-
-void XWindowInterface::activeWindowChanged(WId win)
+void XWindowInterface::windowsChanged(const QList<WId> &windows, bool stackingOrderChanged)
 {
-    m_activeWindow = win;
+    bool wasCovered = dockIsCovered();
+    bool wasCovering = dockIsCovering();
+    bool activeChanged = false;
+    WId dock = m_dockWindow->winId();
 
-    emit AbstractInterface::activeWindowChanged();
-}
+    if (stackingOrderChanged) {
+        updateStackingOrder();
+    }
 
-void XWindowInterface::windowChanged (WId id, NET::Properties properties, NET::Properties2 properties2)
-{
-    KWindowInfo info(id, NET::WMState|NET::CloseWindow);
+    foreach (WId id, windows) {
+        WindowInfo info = m_tracker->windowInfo(id);
 
-    if (info.valid()) {
-        if ((m_demandsAttention == 0) && info.hasState(NET::DemandsAttention)) {
-            m_demandsAttention = id;
-            emit windowInAttention(true);
-        } else if ((m_demandsAttention == id) && !info.hasState(NET::DemandsAttention)) {
-            m_demandsAttention = 0;
-            emit windowInAttention(false);
+        updateIndex(id, info);
+        updateAttention(id, info);
+
+        if (id == m_tracker->activeWindow()) {
+            activeChanged = true;
         }
     }
 
-  //  emit AbstractInterface::windowChanged();
-
-    if (id==m_activeWindow) {
-        emit AbstractInterface::activeWindowChanged();
+    if (windows.contains(dock) && (m_dockState != dockState())) {
+        m_dockState = dockState();
+        emit AbstractInterface::dockStateChanged();
     }
-}
 
-void XWindowInterface::windowRemoved (WId id)
-{
-    if (id==m_demandsAttention) {
-        m_demandsAttention = 0;
-        emit AbstractInterface::windowInAttention(false);
+    if (activeChanged || (wasCovered != dockIsCovered()) || (wasCovering != dockIsCovering())) {
+        emit AbstractInterface::windowChanged();
     }
 }
 
@@ -2,14 +2,23 @@
 #define XWINDOWINTERFACE_H
 
 #include <QObject>
-
-#include <KWindowInfo>
+#include <QSharedPointer>
 
 #include "abstractinterface.h"
+#include "windowgeometryindex.h"
+#include "windowinfo.h"
+#include "xwindowtracker.h"
 
 namespace NowDock
 {
 
+/*
+ * The view of a dock on the windows of the shared XWindowTracker, it
+ * keeps only the windows that can cover the dock in its own index and
+ * answers the visibility questions for its mask area. Only the windows
+ * that are on the screen of the dock, even partially, are kept, so the
+ * windows of the other screens are never checked.
+ */
 class XWindowInterface : public AbstractInterface {
     Q_OBJECT
 
@@ -26,6 +35,10 @@ public:
     bool dockInNormalState() const;
     bool dockIsBelow() const;
 
+    void setInputMask(QRect area);
+    void setMaskArea(QRect area);
+    void setScreenGeometry(QRect geometry);
+
     void setDockToAllDesktops();
     void setDockToAlwaysVisible();
     void showDockAsNormal();
@@ -34,13 +47,39 @@ public:
 
 private Q_SLOTS:
     void activeWindowChanged(WId win);
-    void windowChanged (WId id, NET::Properties properties, NET::Properties2 properties2);
-    void windowRemoved (WId id);
+    void dockGeometryChanged();
+    void windowsChanged(const QList<WId> &windows, bool stackingOrderChanged);
 
 private:
-    WId m_activeWindow;
     WId m_demandsAttention;
 
+    //1 on top, 0 normal, -1 on bottom, as reported by the window system
+    int m_dockState;
+
+    //the covered/covering answers are recomputed only when the stacking order
+    //or the windows that overlap the dock change
+    mutable bool m_coverageDirty;
+    mutable bool m_dockIsCovered;
+    mutable bool m_dockIsCovering;
+
+    int m_dockPosition;
+
+    //windows that can cover the dock, e.g. they are not minimized or desktops
+    WindowGeometryIndex m_windowsIndex;
+
+    QSharedPointer<XWindowTracker> m_tracker;
+
+    QRect dockGeometry() const;
+    bool canCoverDock(WId id, const WindowInfo &info) const;
+    int dockState() const;
+    WId dockTransient() const;
+    void updateCoverage() const;
+    void updateIndex(WId id, const WindowInfo &info);
+    void updateAttention(WId id, const WindowInfo &info);
+    //fills the index again, e.g. when the dock has moved to another screen
+    void updateIndexes();
+    void updateStackingOrder();
+
     bool isDesktop(WId id) const;
     bool isMaximized(WId id) const;
     bool isNormal(WId id) const;
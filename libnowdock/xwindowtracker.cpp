@@ -0,0 +1,291 @@
+#include "xwindowtracker.h"
+
+#include "xwindowwatcher.h"
+
+#include <QThread>
+#include <QWeakPointer>
+#include <QX11Info>
+
+#include <KWindowInfo>
+#include <KWindowSystem>
+
+namespace NowDock
+{
+
+XWindowTracker::XWindowTracker() :
+    QObject(0),
+    m_activeWindow(0),
+    m_stackingOrderPending(false),
+    m_watcherThread(0),
+    m_watcher(0)
+{
+    m_dispatchTimer.setSingleShot(true);
+    m_dispatchTimer.setInterval(0);
+    connect(&m_dispatchTimer, &QTimer::timeout, this, &XWindowTracker::dispatchWindowChanges);
+
+    if (qEnvironmentVariableIsSet("NOWDOCK_WINDOW_THREAD") && startWatcher()) {
+        return;
+    }
+
+    m_activeWindow = KWindowSystem::activeWindow();
+    setStackingOrder(KWindowSystem::stackingOrder());
+
+    updateWindows(KWindowSystem::windows());
+
+    connect(KWindowSystem::self(), SIGNAL(activeWindowChanged(WId)), this, SLOT(setActiveWindow(WId)));
+    connect(KWindowSystem::self(), SIGNAL(stackingOrderChanged()), this, SLOT(stackingOrderChanged()));
+    connect(KWindowSystem::self(), SIGNAL(windowAdded(WId)), this, SLOT(windowAdded(WId)));
+    connect(KWindowSystem::self(), SIGNAL(windowChanged (WId,NET::Properties,NET::Properties2)), this, SLOT(windowChanged (WId,NET::Properties,NET::Properties2)));
+    connect(KWindowSystem::self(), SIGNAL(windowRemoved(WId)), this, SLOT(windowRemoved(WId)));
+}
+
+XWindowTracker::~XWindowTracker()
+{
+    if (m_watcher) {
+        m_watcherThread->quit();
+        m_watcherThread->wait();
+
+        delete m_watcher;
+    }
+}
+
+bool XWindowTracker::startWatcher()
+{
+    if (!QX11Info::isPlatformX11()) {
+        return false;
+    }
+
+    XWindowWatcher *watcher = new XWindowWatcher();
+
+    if (!watcher->isValid()) {
+        delete watcher;
+        return false;
+    }
+
+    m_watcher = watcher;
+    m_snapshot = m_watcher->snapshot();
+
+    m_watcherThread = new QThread(this);
+    m_watcher->moveToThread(m_watcherThread);
+
+    connect(m_watcherThread, &QThread::started, m_watcher, &XWindowWatcher::start);
+    //finished is sent from the worker thread, the connection is closed there
+    connect(m_watcherThread, &QThread::finished, m_watcher, &XWindowWatcher::stop, Qt::DirectConnection);
+    connect(m_watcher, &XWindowWatcher::snapshotPublished, this, &XWindowTracker::snapshotPublished, Qt::QueuedConnection);
+
+    m_watcherThread->start();
+
+    return true;
+}
+
+QSharedPointer<XWindowTracker> XWindowTracker::instance()
+{
+    static QWeakPointer<XWindowTracker> s_instance;
+
+    QSharedPointer<XWindowTracker> tracker = s_instance.toStrongRef();
+
+    if (!tracker) {
+        tracker = QSharedPointer<XWindowTracker>(new XWindowTracker());
+        s_instance = tracker;
+    }
+
+    return tracker;
+}
+
+WId XWindowTracker::activeWindow() const
+{
+    return m_watcher ? m_snapshot->activeWindow : m_activeWindow;
+}
+
+QHash<WId, int> XWindowTracker::stackingPositions() const
+{
+    return m_watcher ? m_snapshot->stackingPositions : m_stackingPositions;
+}
+
+void XWindowTracker::setStackingOrder(const QList<WId> &windows)
+{
+    m_stackingPositions.clear();
+    m_stackingPositions.reserve(windows.count());
+
+    for (int i=0; i<windows.count(); ++i) {
+        m_stackingPositions.insert(windows.at(i), i);
+    }
+}
+
+QList<WId> XWindowTracker::windows() const
+{
+    return m_watcher ? m_snapshot->windows.keys() : m_windows.keys();
+}
+
+WindowInfo XWindowTracker::requestInfo(WId id) const
+{
+    KWindowInfo info(id, NET::WMState | NET::XAWMState | NET::WMGeometry | NET::WMWindowType);
+
+    return WindowInfo(info);
+}
+
+WindowInfo XWindowTracker::windowInfo(WId id) const
+{
+    return m_watcher ? m_snapshot->windows.value(id) : m_windows.value(id);
+}
+
+void XWindowTracker::updateWindows(const QList<WId> &windows)
+{
+    if (!m_fetcher.isValid()) {
+        foreach (WId id, windows) {
+            WindowInfo info = requestInfo(id);
+
+            if (info.isValid()) {
+                m_windows.insert(id, info);
+            } else {
+                m_windows.remove(id);
+            }
+        }
+
+        return;
+    }
+
+    QHash<WId, WindowInfo> infos = m_fetcher.fetch(windows);
+
+    foreach (WId id, windows) {
+        WindowInfo info = infos.value(id);
+
+        if (info.isValid()) {
+            m_windows.insert(id, info);
+        } else {
+            m_windows.remove(id);
+        }
+    }
+}
+
+void XWindowTracker::requestDispatch()
+{
+    if (!m_dispatchTimer.isActive()) {
+        m_dispatchTimer.start();
+    }
+}
+
+/*
+ * SLOTS
+ */
+
+void XWindowTracker::setActiveWindow(WId id)
+{
+    m_activeWindow = id;
+
+    //a new window is often activated before its pending changes are sent,
+    //they are sent first so that the docks can read its info
+    if (id && (m_pendingWindows.contains(id) || !m_windows.contains(id))) {
+        m_pendingWindows.insert(id);
+        m_dispatchTimer.stop();
+        dispatchWindowChanges();
+    }
+
+    emit activeWindowChanged(id);
+}
+
+void XWindowTracker::stackingOrderChanged()
+{
+    m_stackingOrderPending = true;
+    requestDispatch();
+}
+
+void XWindowTracker::windowAdded(WId id)
+{
+    m_pendingWindows.insert(id);
+    requestDispatch();
+}
+
+void XWindowTracker::windowChanged(WId id, NET::Properties properties, NET::Properties2 properties2)
+{
+    //changes e.g. in titles and icons can not affect the dock visibility
+    if (!(properties & (NET::WMState | NET::XAWMState | NET::WMGeometry | NET::WMWindowType | NET::WMDesktop))) {
+        return;
+    }
+
+    m_pendingWindows.insert(id);
+    requestDispatch();
+}
+
+void XWindowTracker::windowRemoved(WId id)
+{
+    //it is sent with the next changes, its info is not valid any more
+    m_windows.remove(id);
+    m_pendingWindows.insert(id);
+    requestDispatch();
+}
+
+void XWindowTracker::dispatchWindowChanges()
+{
+    bool stackingChanged = m_stackingOrderPending;
+
+    if (m_stackingOrderPending) {
+        m_stackingOrderPending = false;
+        setStackingOrder(KWindowSystem::stackingOrder());
+    }
+
+    QList<WId> windows = m_pendingWindows.toList();
+    m_pendingWindows.clear();
+
+    if (!windows.isEmpty()) {
+        QList<WId> existing;
+
+        foreach (WId id, windows) {
+            if (KWindowSystem::hasWId(id)) {
+                existing.append(id);
+            } else {
+                m_windows.remove(id);
+            }
+        }
+
+        updateWindows(existing);
+    }
+
+    if (stackingChanged || !windows.isEmpty()) {
+        emit windowsChanged(windows, stackingChanged);
+    }
+}
+
+/*
+ * The snapshots that are published before this one is handled are skipped,
+ * the docks are notified about the differences from the last one that they
+ * have seen.
+ */
+void XWindowTracker::snapshotPublished()
+{
+    std::shared_ptr<const WindowSnapshot> snapshot = m_watcher->snapshot();
+
+    if (snapshot == m_snapshot) {
+        return;
+    }
+
+    std::shared_ptr<const WindowSnapshot> previous = m_snapshot;
+    m_snapshot = snapshot;
+
+    bool stackingChanged = (previous->stackingOrder != snapshot->stackingOrder);
+    QList<WId> windows;
+
+    QHash<WId, WindowInfo>::const_iterator it;
+
+    for (it = snapshot->windows.constBegin(); it != snapshot->windows.constEnd(); ++it) {
+        if (previous->windows.value(it.key()) != it.value()) {
+            windows.append(it.key());
+        }
+    }
+
+    for (it = previous->windows.constBegin(); it != previous->windows.constEnd(); ++it) {
+        if (!snapshot->windows.contains(it.key())) {
+            windows.append(it.key());
+        }
+    }
+
+    if (previous->activeWindow != snapshot->activeWindow) {
+        emit activeWindowChanged(snapshot->activeWindow);
+    }
+
+    if (stackingChanged || !windows.isEmpty()) {
+        emit windowsChanged(windows, stackingChanged);
+    }
+}
+
+}
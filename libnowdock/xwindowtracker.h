@@ -0,0 +1,104 @@
+#ifndef XWINDOWTRACKER_H
+#define XWINDOWTRACKER_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QTimer>
+
+#include <KWindowInfo>
+
+#include <memory>
+
+#include "windowinfo.h"
+#include "windowsnapshot.h"
+#include "xwindowinfofetcher.h"
+
+class QThread;
+
+namespace NowDock
+{
+
+class XWindowWatcher;
+
+/*
+ * Tracks the windows for all the docks of the process. It is connected to
+ * KWindowSystem once and it queries the X server once for every change,
+ * the docks only read the cached properties and keep their own view of
+ * them for their mask area. The changes of an event loop pass are sent
+ * together in a single windowsChanged. The tracker is shared between the
+ * docks and it is deleted together with the last one.
+ *
+ * With the NOWDOCK_WINDOW_THREAD environment variable the windows are
+ * watched instead from a worker thread with its own connection to the X
+ * server, see XWindowWatcher. The tracker then reads only the snapshots
+ * that the worker publishes and never waits for the X server.
+ */
+class XWindowTracker : public QObject {
+    Q_OBJECT
+
+public:
+    ~XWindowTracker();
+
+    static QSharedPointer<XWindowTracker> instance();
+
+    WId activeWindow() const;
+    //the index of every window in the stacking order, bottom to top
+    QHash<WId, int> stackingPositions() const;
+    QList<WId> windows() const;
+
+    //not valid if the window is not known, e.g. it has been added but its
+    //changes have not been sent yet or it has been removed, the X server is
+    //never queried for it
+    WindowInfo windowInfo(WId id) const;
+
+Q_SIGNALS:
+    //the info of the new active window is already valid, its pending
+    //changes are sent before
+    void activeWindowChanged(WId id);
+    //windows: the windows that have been added, changed or removed, the
+    //removed ones don't have a valid info any more
+    void windowsChanged(const QList<WId> &windows, bool stackingOrderChanged);
+
+private Q_SLOTS:
+    void dispatchWindowChanges();
+    void setActiveWindow(WId id);
+    void snapshotPublished();
+    void stackingOrderChanged();
+    void windowAdded(WId id);
+    void windowChanged(WId id, NET::Properties properties, NET::Properties2 properties2);
+    void windowRemoved(WId id);
+
+private:
+    XWindowTracker();
+
+    WId m_activeWindow;
+
+    bool m_stackingOrderPending;
+    QHash<WId, int> m_stackingPositions;
+
+    QSet<WId> m_pendingWindows;
+    QTimer m_dispatchTimer;
+
+    QHash<WId, WindowInfo> m_windows;
+
+    XWindowInfoFetcher m_fetcher;
+
+    //only in the threaded mode
+    QThread *m_watcherThread;
+    XWindowWatcher *m_watcher;
+    //the snapshot that the docks have been notified about
+    std::shared_ptr<const WindowSnapshot> m_snapshot;
+
+    void requestDispatch();
+    WindowInfo requestInfo(WId id) const;
+    void setStackingOrder(const QList<WId> &windows);
+    bool startWatcher();
+    void updateWindows(const QList<WId> &windows);
+};
+
+}
+
+#endif
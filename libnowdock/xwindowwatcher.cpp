@@ -0,0 +1,318 @@
+#include "xwindowwatcher.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include <QDebug>
+#include <QSocketNotifier>
+
+namespace NowDock
+{
+
+static const char *watcherAtomNames[] = {
+    "_NET_ACTIVE_WINDOW",
+    "_NET_CLIENT_LIST_STACKING",
+    "_NET_WM_STATE",
+    "_NET_WM_WINDOW_TYPE",
+    "WM_STATE"
+};
+
+template <typename T>
+using XcbReply = QScopedPointer<T, QScopedPointerPodDeleter>;
+
+XWindowWatcher::XWindowWatcher() :
+    QObject(0),
+    m_activePending(false),
+    m_stackingOrderPending(false),
+    m_connection(0),
+    m_rootWindow(XCB_WINDOW_NONE),
+    m_notifier(0),
+    m_snapshot(std::make_shared<const WindowSnapshot>())
+{
+    for (int i=0; i<AtomsCount; ++i) {
+        m_atoms[i] = XCB_ATOM_NONE;
+    }
+
+    int screenNumber = 0;
+    xcb_connection_t *connection = xcb_connect(0, &screenNumber);
+
+    if (xcb_connection_has_error(connection)) {
+        xcb_disconnect(connection);
+        return;
+    }
+
+    xcb_screen_iterator_t it = xcb_setup_roots_iterator(xcb_get_setup(connection));
+
+    for (int i=0; (i<screenNumber) && it.rem; ++i) {
+        xcb_screen_next(&it);
+    }
+
+    if (!it.rem) {
+        xcb_disconnect(connection);
+        return;
+    }
+
+    m_connection = connection;
+    m_rootWindow = it.data->root;
+}
+
+XWindowWatcher::~XWindowWatcher()
+{
+    stop();
+}
+
+bool XWindowWatcher::isValid() const
+{
+    return m_connection != 0;
+}
+
+std::shared_ptr<const WindowSnapshot> XWindowWatcher::snapshot() const
+{
+    return std::atomic_load(&m_snapshot);
+}
+
+void XWindowWatcher::start()
+{
+    if (!m_connection || m_notifier) {
+        return;
+    }
+
+    xcb_intern_atom_cookie_t cookies[AtomsCount];
+
+    for (int i=0; i<AtomsCount; ++i) {
+        cookies[i] = xcb_intern_atom(m_connection, false, strlen(watcherAtomNames[i]), watcherAtomNames[i]);
+    }
+
+    for (int i=0; i<AtomsCount; ++i) {
+        XcbReply<xcb_intern_atom_reply_t> reply(xcb_intern_atom_reply(m_connection, cookies[i], 0));
+
+        if (reply) {
+            m_atoms[i] = reply->atom;
+        }
+    }
+
+    m_fetcher.reset(new XWindowInfoFetcher(m_connection, m_rootWindow));
+
+    //the stacking order and the active window are properties of the root window
+    uint32_t mask = XCB_EVENT_MASK_PROPERTY_CHANGE;
+    xcb_change_window_attributes(m_connection, m_rootWindow, XCB_CW_EVENT_MASK, &mask);
+
+    m_notifier = new QSocketNotifier(xcb_get_file_descriptor(m_connection), QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &XWindowWatcher::processEvents);
+
+    m_activePending = true;
+    m_stackingOrderPending = true;
+
+    processEvents();
+}
+
+void XWindowWatcher::stop()
+{
+    //it can be called from the activated signal of the notifier
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+        m_notifier->deleteLater();
+        m_notifier = 0;
+    }
+
+    m_fetcher.reset();
+
+    if (m_connection) {
+        xcb_disconnect(m_connection);
+        m_connection = 0;
+    }
+}
+
+void XWindowWatcher::processEvents()
+{
+    if (!m_connection) {
+        return;
+    }
+
+    xcb_generic_event_t *event;
+
+    while ((event = xcb_poll_for_event(m_connection))) {
+        handleEvent(event);
+        free(event);
+    }
+
+    if (m_activePending || m_stackingOrderPending || !m_pendingWindows.isEmpty()) {
+        publish();
+
+        //the events that arrived together with the replies are already read from
+        //the socket, so they are handled in the next pass of the event loop
+        while ((event = xcb_poll_for_queued_event(m_connection))) {
+            handleEvent(event);
+            free(event);
+        }
+
+        if (m_activePending || m_stackingOrderPending || !m_pendingWindows.isEmpty()) {
+            QMetaObject::invokeMethod(this, "processEvents", Qt::QueuedConnection);
+        }
+    }
+
+    if (xcb_connection_has_error(m_connection)) {
+        qWarning() << "The connection of the window watcher to the X server has been lost";
+        stop();
+    }
+}
+
+void XWindowWatcher::handleEvent(xcb_generic_event_t *event)
+{
+    //the window manager sends synthetic events e.g. when it moves a window
+    switch (event->response_type & ~0x80) {
+        case XCB_PROPERTY_NOTIFY: {
+            xcb_property_notify_event_t *propertyEvent = reinterpret_cast<xcb_property_notify_event_t *>(event);
+
+            if (propertyEvent->window == m_rootWindow) {
+                if (propertyEvent->atom == m_atoms[ActiveWindow]) {
+                    m_activePending = true;
+                } else if (propertyEvent->atom == m_atoms[ClientListStacking]) {
+                    m_stackingOrderPending = true;
+                }
+            } else if ((propertyEvent->atom == m_atoms[NetWmState]) || (propertyEvent->atom == m_atoms[NetWmWindowType])
+                       || (propertyEvent->atom == m_atoms[WmState])) {
+                m_pendingWindows.insert(propertyEvent->window);
+            }
+
+            break;
+        }
+
+        case XCB_CONFIGURE_NOTIFY: {
+            xcb_configure_notify_event_t *configureEvent = reinterpret_cast<xcb_configure_notify_event_t *>(event);
+
+            m_pendingWindows.insert(configureEvent->window);
+            break;
+        }
+
+        default:
+            //e.g. the errors for windows that have been destroyed
+            break;
+    }
+}
+
+/*
+ * The new snapshot starts as a copy of the current one, the containers are
+ * shared until they are changed. All the requests of the pass are sent
+ * before any reply is read.
+ */
+void XWindowWatcher::publish()
+{
+    std::shared_ptr<const WindowSnapshot> current = std::atomic_load(&m_snapshot);
+    std::shared_ptr<WindowSnapshot> next = std::make_shared<WindowSnapshot>(*current);
+
+    bool activePending = m_activePending;
+    bool stackingOrderPending = m_stackingOrderPending;
+
+    m_activePending = false;
+    m_stackingOrderPending = false;
+
+    xcb_get_property_cookie_t activeCookie = {0};
+    xcb_get_property_cookie_t stackingCookie = {0};
+
+    if (activePending) {
+        activeCookie = xcb_get_property(m_connection, false, m_rootWindow, m_atoms[ActiveWindow], XCB_ATOM_WINDOW, 0, 1);
+    }
+
+    if (stackingOrderPending) {
+        stackingCookie = xcb_get_property(m_connection, false, m_rootWindow, m_atoms[ClientListStacking], XCB_ATOM_WINDOW, 0, 0xffff);
+    }
+
+    if (activePending) {
+        XcbReply<xcb_get_property_reply_t> reply(xcb_get_property_reply(m_connection, activeCookie, 0));
+
+        next->activeWindow = 0;
+
+        if (reply && (reply->format == 32) && (xcb_get_property_value_length(reply.data()) >= 4)) {
+            next->activeWindow = *static_cast<xcb_window_t *>(xcb_get_property_value(reply.data()));
+        }
+    }
+
+    if (stackingOrderPending) {
+        XcbReply<xcb_get_property_reply_t> reply(xcb_get_property_reply(m_connection, stackingCookie, 0));
+
+        QList<WId> windows;
+
+        if (reply && (reply->format == 32)) {
+            xcb_window_t *values = static_cast<xcb_window_t *>(xcb_get_property_value(reply.data()));
+            int count = xcb_get_property_value_length(reply.data()) / sizeof(xcb_window_t);
+
+            windows.reserve(count);
+
+            for (int i=0; i<count; ++i) {
+                windows.append(values[i]);
+            }
+        }
+
+        next->stackingOrder = windows;
+        next->stackingPositions.clear();
+        next->stackingPositions.reserve(windows.count());
+
+        QList<WId> added;
+
+        for (int i=0; i<windows.count(); ++i) {
+            next->stackingPositions.insert(windows.at(i), i);
+
+            if (!next->windows.contains(windows.at(i))) {
+                added.append(windows.at(i));
+            }
+        }
+
+        //the windows that are not managed any more
+        QHash<WId, WindowInfo>::iterator it = next->windows.begin();
+
+        while (it != next->windows.end()) {
+            if (next->stackingPositions.contains(it.key())) {
+                ++it;
+            } else {
+                m_pendingWindows.remove(it.key());
+                it = next->windows.erase(it);
+            }
+        }
+
+        watchWindows(added);
+
+        foreach (WId id, added) {
+            m_pendingWindows.insert(id);
+        }
+    }
+
+    //only the windows that are managed are tracked
+    QList<WId> pending;
+
+    foreach (WId id, m_pendingWindows) {
+        if (next->stackingPositions.contains(id)) {
+            pending.append(id);
+        }
+    }
+
+    m_pendingWindows.clear();
+
+    QHash<WId, WindowInfo> infos = m_fetcher->fetch(pending);
+
+    foreach (WId id, pending) {
+        WindowInfo info = infos.value(id);
+
+        if (info.isValid()) {
+            next->windows.insert(id, info);
+        } else {
+            next->windows.remove(id);
+        }
+    }
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const WindowSnapshot>(next));
+
+    emit snapshotPublished();
+}
+
+void XWindowWatcher::watchWindows(const QList<WId> &windows)
+{
+    //the state and type properties and the geometry changes
+    uint32_t mask = XCB_EVENT_MASK_PROPERTY_CHANGE | XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+
+    foreach (WId id, windows) {
+        xcb_change_window_attributes(m_connection, id, XCB_CW_EVENT_MASK, &mask);
+    }
+}
+
+}
@@ -0,0 +1,88 @@
+#ifndef XWINDOWWATCHER_H
+#define XWINDOWWATCHER_H
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QSet>
+
+#include <memory>
+
+#include <xcb/xcb.h>
+
+#include "windowsnapshot.h"
+#include "xwindowinfofetcher.h"
+
+class QSocketNotifier;
+
+namespace NowDock
+{
+
+/*
+ * Watches the windows from a worker thread with its own xcb connection,
+ * so a slow X server never blocks the thread of the docks. The changes of
+ * every batch of X events are fetched together and published as a new
+ * WindowSnapshot, the pointer to the latest one is swapped atomically and
+ * the readers keep the snapshot that they have taken as long as they need.
+ *
+ *     watcher->moveToThread(thread);
+ *     connect(thread, &QThread::started, watcher, &XWindowWatcher::start);
+ */
+class XWindowWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    XWindowWatcher();
+    ~XWindowWatcher();
+
+    //there is a connection to the X server
+    bool isValid() const;
+
+    //the latest published snapshot, it can be called from any thread
+    std::shared_ptr<const WindowSnapshot> snapshot() const;
+
+Q_SIGNALS:
+    //it is sent from the worker thread
+    void snapshotPublished();
+
+public slots:
+    //they must be called in the worker thread
+    void start();
+    void stop();
+
+private Q_SLOTS:
+    void processEvents();
+
+private:
+    enum Atom {
+        ActiveWindow = 0,
+        ClientListStacking,
+        NetWmState,
+        NetWmWindowType,
+        WmState,
+        AtomsCount
+    };
+
+    bool m_activePending;
+    bool m_stackingOrderPending;
+
+    xcb_connection_t *m_connection;
+    xcb_window_t m_rootWindow;
+    xcb_atom_t m_atoms[AtomsCount];
+
+    QSet<WId> m_pendingWindows;
+
+    QSocketNotifier *m_notifier;
+
+    QScopedPointer<XWindowInfoFetcher> m_fetcher;
+
+    //only through std::atomic_load and std::atomic_store
+    std::shared_ptr<const WindowSnapshot> m_snapshot;
+
+    void handleEvent(xcb_generic_event_t *event);
+    void publish();
+    void watchWindows(const QList<WId> &windows);
+};
+
+}
+
+#endif
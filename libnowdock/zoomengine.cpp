@@ -0,0 +1,431 @@
+#include "zoomengine.h"
+
+#include "instrumentation.h"
+
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QVariant>
+
+namespace NowDock
+{
+
+ZoomEngine::ZoomEngine(QObject *parent) :
+    QObject(parent),
+    m_zoomPending(false),
+    m_hoveredIndex(-1),
+    m_iconMargin(0),
+    m_iconSize(64),
+    m_pendingIndex(-1),
+    m_pendingLength(0),
+    m_pendingPosition(0),
+    m_radius(1.5),
+    m_zoomFactor(1),
+    m_falloff(Linear)
+{
+    updateTable();
+}
+
+ZoomEngine::~ZoomEngine()
+{
+}
+
+ZoomEngine::Falloff ZoomEngine::falloff() const
+{
+    return m_falloff;
+}
+
+void ZoomEngine::setFalloff(Falloff falloff)
+{
+    if (m_falloff == falloff) {
+        return;
+    }
+
+    m_falloff = falloff;
+    updateTable();
+
+    emit falloffChanged();
+}
+
+int ZoomEngine::hoveredIndex() const
+{
+    return m_hoveredIndex;
+}
+
+void ZoomEngine::setHoveredIndex(int index)
+{
+    if (m_hoveredIndex == index) {
+        return;
+    }
+
+    m_hoveredIndex = index;
+
+    if (m_hoveredIndex == -1) {
+        m_zoomPending = false;
+    }
+
+    //restore the items that are out of the zoom radius of the hovered one
+    int reach = m_table.reach();
+
+    foreach (int zoomed, m_zoomed) {
+        if ((m_hoveredIndex == -1) || (qAbs(m_hoveredIndex - zoomed) > reach)) {
+            setItemScale(zoomed, m_items.value(zoomed), 1);
+        }
+    }
+
+    emit hoveredIndexChanged();
+}
+
+int ZoomEngine::iconMargin() const
+{
+    return m_iconMargin;
+}
+
+void ZoomEngine::setIconMargin(int margin)
+{
+    if (m_iconMargin == margin) {
+        return;
+    }
+
+    m_iconMargin = margin;
+    updateTable();
+
+    emit iconMarginChanged();
+}
+
+int ZoomEngine::iconSize() const
+{
+    return m_iconSize;
+}
+
+void ZoomEngine::setIconSize(int size)
+{
+    if (m_iconSize == size) {
+        return;
+    }
+
+    m_iconSize = size;
+    updateTable();
+
+    emit iconSizeChanged();
+}
+
+qreal ZoomEngine::maximumLengthIncrease() const
+{
+    return m_table.maximumLengthIncrease();
+}
+
+qreal ZoomEngine::radius() const
+{
+    return m_radius;
+}
+
+void ZoomEngine::setRadius(qreal radius)
+{
+    //the hovered item and its neighbours are always zoomed
+    radius = qMax(radius, qreal(1));
+
+    if (qFuzzyCompare(m_radius, radius)) {
+        return;
+    }
+
+    m_radius = radius;
+    updateTable();
+
+    emit radiusChanged();
+}
+
+qreal ZoomEngine::zoomFactor() const
+{
+    return m_zoomFactor;
+}
+
+void ZoomEngine::setZoomFactor(qreal factor)
+{
+    if (qFuzzyCompare(m_zoomFactor, factor)) {
+        return;
+    }
+
+    m_zoomFactor = factor;
+    updateTable();
+
+    emit zoomFactorChanged();
+}
+
+void ZoomEngine::clear()
+{
+    m_zoomPending = false;
+
+    foreach (int zoomed, m_zoomed) {
+        setItemScale(zoomed, m_items.value(zoomed), 1);
+    }
+
+    m_zoomed.clear();
+
+    resetSpacers(m_spacers);
+    m_spacers.clear();
+
+    setHoveredIndex(-1);
+}
+
+void ZoomEngine::hover(int index, qreal position, qreal length)
+{
+    Instrumentation::Scope scope(Instrumentation::ZoomHover);
+
+    QQuickItem *item = qobject_cast<QQuickItem *>(m_items.value(index));
+
+    if (!item || (position <= 0) || (length <= 0)) {
+        return;
+    }
+
+    //only the last position is used when the next frame is prepared
+    m_pendingIndex = index;
+    m_pendingPosition = position;
+    m_pendingLength = length;
+
+    QQuickWindow *window = item->window();
+
+    if (!window) {
+        zoom(index, position, length);
+        return;
+    }
+
+    if (m_window != window) {
+        if (m_window) {
+            disconnect(m_window, &QQuickWindow::afterAnimating, this, &ZoomEngine::updateZoom);
+        }
+
+        m_window = window;
+        connect(m_window, &QQuickWindow::afterAnimating, this, &ZoomEngine::updateZoom);
+    }
+
+    if (!m_zoomPending) {
+        m_zoomPending = true;
+        m_window->update();
+    }
+}
+
+/*
+ * Called once per frame from the gui thread, after the animations have
+ * been advanced and before the scene is synchronized with the renderer,
+ * so all the new scales are part of the same frame.
+ */
+void ZoomEngine::updateZoom()
+{
+    if (!m_zoomPending) {
+        return;
+    }
+
+    m_zoomPending = false;
+
+    zoom(m_pendingIndex, m_pendingPosition, m_pendingLength);
+}
+
+void ZoomEngine::zoom(int index, qreal position, qreal length)
+{
+    Instrumentation::Scope scope(Instrumentation::Zoom);
+
+    QObject *item = m_items.value(index);
+
+    if (!item) {
+        return;
+    }
+
+    setHoveredIndex(index);
+
+    m_slots.clear();
+
+    Slot hovered = {index, 0, NoSpacer};
+    m_slots.append(hovered);
+
+    collectSlots(index, -1);
+    collectSlots(index, 1);
+
+    int row = m_table.row(position / length);
+
+    QSet<int> previous = m_zoomed;
+    QSet<int> previousSpacers = m_spacers;
+
+    m_spacers.clear();
+
+    for (int i=0; i<m_slots.count(); ++i) {
+        const Slot &slot = m_slots.at(i);
+        QObject *slotItem = m_items.value(slot.index);
+        qreal scale = m_table.scale(row, slot.offset);
+
+        if (slot.spacer != NoSpacer) {
+            slotItem->setProperty(slot.spacer == LeftSpacer ? "leftSpacerScale" : "rightSpacerScale", scale - 1);
+            m_spacers.insert(slot.index);
+            previousSpacers.remove(slot.index);
+        } else if (slotItem->property("zoomExternal").toBool()) {
+            emit externalScaleRequested(slot.index, scale, 0);
+            previous.remove(slot.index);
+        } else {
+            setItemScale(slot.index, slotItem, scale);
+            previous.remove(slot.index);
+        }
+    }
+
+    //the items that were zoomed from a previous position and are out of the radius now
+    foreach (int zoomed, previous) {
+        setItemScale(zoomed, m_items.value(zoomed), 1);
+    }
+
+    resetSpacers(previousSpacers);
+}
+
+void ZoomEngine::removeItem(QObject *item)
+{
+    setItem(-1, item);
+}
+
+void ZoomEngine::setItem(int index, QObject *item)
+{
+    if (!item) {
+        return;
+    }
+
+    QHash<int, QPointer<QObject> >::iterator it = m_items.begin();
+
+    while (it != m_items.end()) {
+        if (it.value() == item || it.value().isNull()) {
+            m_zoomed.remove(it.key());
+            m_spacers.remove(it.key());
+            it = m_items.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (index >= 0) {
+        m_items.insert(index, item);
+    }
+}
+
+/*
+ * Collects the items next to the hovered one, in the given direction, that
+ * are in the zoom radius. Hidden items and splitters don't take a slot,
+ * items that can't be zoomed or zoom themselves stop the zoom wave. At the
+ * end of the layout the hidden spacer of the last item takes the slot.
+ */
+void ZoomEngine::collectSlots(int index, int direction)
+{
+    int reach = m_table.reach();
+    int slot = direction;
+    int current = index + direction;
+    int edge = index;
+
+    while (qAbs(slot) <= reach) {
+        QObject *item = m_items.value(current);
+
+        if (!item) {
+            if (m_items.count() > 1) {
+                Slot spacer = {edge, slot, direction < 0 ? LeftSpacer : RightSpacer};
+                m_slots.append(spacer);
+            }
+
+            return;
+        }
+
+        bool accept = item->property("zoomAccept").toBool();
+
+        if (!accept) {
+            if (item->property("zoomForward").toBool()) {
+                current += direction;
+                continue;
+            }
+
+            return;
+        }
+
+        Slot itemSlot = {current, slot, NoSpacer};
+        m_slots.append(itemSlot);
+
+        if (item->property("zoomExternal").toBool()) {
+            return;
+        }
+
+        edge = current;
+        current += direction;
+        slot += direction;
+    }
+}
+
+void ZoomEngine::resetSpacers(const QSet<int> &indexes)
+{
+    foreach (int index, indexes) {
+        QObject *item = m_items.value(index);
+
+        if (item) {
+            item->setProperty("leftSpacerScale", 0);
+            item->setProperty("rightSpacerScale", 0);
+        }
+    }
+}
+
+void ZoomEngine::updateTable()
+{
+    qreal increase = m_table.maximumLengthIncrease();
+
+    m_table.build(m_zoomFactor, m_radius, static_cast<ZoomKernel::Falloff>(m_falloff), m_iconSize, m_iconMargin);
+
+    if (m_table.maximumLengthIncrease() != increase) {
+        emit maximumLengthIncreaseChanged();
+    }
+}
+
+void ZoomEngine::updateScale(int index, qreal scale, qreal step)
+{
+    applyScale(index, scale, step);
+}
+
+/*
+ * Applies the scale to the item at the index, hidden items and splitters
+ * send it further away from the hovered item. Returns false if there
+ * isn't any item at that index.
+ */
+bool ZoomEngine::applyScale(int index, qreal scale, qreal step)
+{
+    QObject *item = m_items.value(index);
+
+    if (!item) {
+        return false;
+    }
+
+    if (item->property("zoomAccept").toBool()) {
+        if (item->property("zoomExternal").toBool()) {
+            emit externalScaleRequested(index, scale, step);
+        } else if (scale >= 0) {
+            setItemScale(index, item, scale + step);
+        } else {
+            setItemScale(index, item, item->property("zoomScale").toReal() + step);
+        }
+    } else if (item->property("zoomForward").toBool()) {
+        if (m_hoveredIndex > index) {
+            applyScale(index - 1, scale, step);
+        } else if (m_hoveredIndex < index) {
+            applyScale(index + 1, scale, step);
+        }
+    }
+
+    return true;
+}
+
+void ZoomEngine::setItemScale(int index, QObject *item, qreal scale)
+{
+    if (!item) {
+        m_zoomed.remove(index);
+        return;
+    }
+
+    if (item->property("zoomScale").toReal() != scale) {
+        item->setProperty("zoomScale", scale);
+    }
+
+    if (scale == 1) {
+        m_zoomed.remove(index);
+    } else {
+        m_zoomed.insert(index);
+    }
+}
+
+}
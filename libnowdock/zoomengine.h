@@ -0,0 +1,166 @@
+#ifndef ZOOMENGINE_H
+#define ZOOMENGINE_H
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QVector>
+
+#include "zoomlookuptable.h"
+
+class QQuickWindow;
+
+namespace NowDock
+{
+
+/*
+ * Computes the parabolic zoom of the applets when the mouse is hovering
+ * the dock. The applets register their wrapper items with their layout
+ * index and the engine writes the new scales directly to the items that
+ * are affected, instead of broadcasting every scale to all the applets.
+ * The scales of all the items in the zoom radius are read together from
+ * a ZoomLookupTable, at most once per frame of the window of the items and
+ * always for the latest mouse position.
+ *
+ * The registered items provide:
+ *   zoomScale        the scale that is changed
+ *   zoomAccept       the item can be zoomed
+ *   zoomForward      the item is hidden or a splitter, its scale is sent to
+ *                    the next item away from the hovered one
+ *   zoomExternal     the item handles the scale itself (the Now Dock plasmoid)
+ *   leftSpacerScale, rightSpacerScale
+ *                    the hidden spacers of the first and last items
+ */
+class ZoomEngine : public QObject {
+    Q_OBJECT
+
+    Q_ENUMS(Falloff)
+
+    Q_PROPERTY(Falloff falloff READ falloff WRITE setFalloff NOTIFY falloffChanged)
+
+    Q_PROPERTY(int hoveredIndex READ hoveredIndex WRITE setHoveredIndex NOTIFY hoveredIndexChanged)
+
+    Q_PROPERTY(int iconMargin READ iconMargin WRITE setIconMargin NOTIFY iconMarginChanged)
+
+    Q_PROPERTY(int iconSize READ iconSize WRITE setIconSize NOTIFY iconSizeChanged)
+
+    /**
+     * the maximum length that the zoom adds to the layout when all
+     * the items in the zoom radius are present
+     */
+    Q_PROPERTY(qreal maximumLengthIncrease READ maximumLengthIncrease NOTIFY maximumLengthIncreaseChanged)
+
+    /**
+     * the distance in item slots from the mouse that the zoom reaches,
+     * 1.5 zooms only the neighbours of the hovered item
+     */
+    Q_PROPERTY(qreal radius READ radius WRITE setRadius NOTIFY radiusChanged)
+
+    Q_PROPERTY(qreal zoomFactor READ zoomFactor WRITE setZoomFactor NOTIFY zoomFactorChanged)
+
+public:
+    //same values with ZoomKernel::Falloff
+    enum Falloff {
+        Linear = 0,
+        Cosine,
+        Gaussian
+    };
+
+    explicit ZoomEngine(QObject *parent = Q_NULLPTR);
+    ~ZoomEngine();
+
+    Falloff falloff() const;
+    void setFalloff(Falloff falloff);
+
+    int hoveredIndex() const;
+    void setHoveredIndex(int index);
+
+    int iconMargin() const;
+    void setIconMargin(int margin);
+
+    int iconSize() const;
+    void setIconSize(int size);
+
+    qreal maximumLengthIncrease() const;
+
+    qreal radius() const;
+    void setRadius(qreal radius);
+
+    qreal zoomFactor() const;
+    void setZoomFactor(qreal factor);
+
+Q_SIGNALS:
+    //the scale must be applied by an item that handles it itself
+    void externalScaleRequested(int index, qreal scale, qreal step);
+    void falloffChanged();
+    void hoveredIndexChanged();
+    void iconMarginChanged();
+    void iconSizeChanged();
+    void maximumLengthIncreaseChanged();
+    void radiusChanged();
+    void zoomFactorChanged();
+
+public slots:
+    Q_INVOKABLE void clear();
+    //position is the mouse position inside the hovered item of the given length
+    Q_INVOKABLE void hover(int index, qreal position, qreal length);
+    Q_INVOKABLE void removeItem(QObject *item);
+    Q_INVOKABLE void setItem(int index, QObject *item);
+    Q_INVOKABLE void updateScale(int index, qreal scale, qreal step);
+
+private Q_SLOTS:
+    void updateZoom();
+
+private:
+    //slots that are not items but the hidden spacers of the edge items
+    enum Spacer {
+        NoSpacer = 0,
+        LeftSpacer,
+        RightSpacer
+    };
+
+    struct Slot {
+        int index;
+        //the distance in slots from the hovered item
+        int offset;
+        Spacer spacer;
+    };
+
+    bool m_zoomPending;
+
+    int m_hoveredIndex;
+    int m_iconMargin;
+    int m_iconSize;
+    int m_pendingIndex;
+    qreal m_pendingLength;
+    qreal m_pendingPosition;
+    qreal m_radius;
+    qreal m_zoomFactor;
+
+    Falloff m_falloff;
+
+    QPointer<QQuickWindow> m_window;
+
+    QHash<int, QPointer<QObject> > m_items;
+    //the indexes that have been zoomed and must be restored
+    QSet<int> m_zoomed;
+    //the items whose hidden spacers have been grown
+    QSet<int> m_spacers;
+
+    ZoomLookupTable m_table;
+
+    //the slots around the hovered item, they are reused for every hover
+    QVector<Slot> m_slots;
+
+    bool applyScale(int index, qreal scale, qreal step);
+    void collectSlots(int index, int direction);
+    void resetSpacers(const QSet<int> &indexes);
+    void updateTable();
+    void zoom(int index, qreal position, qreal length);
+    void setItemScale(int index, QObject *item, qreal scale);
+};
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+#include "zoomkernel.h"
+
+#include <cmath>
+
+namespace NowDock
+{
+
+namespace ZoomKernel
+{
+
+//the hovered item is fully zoomed while the mouse is inside it
+static const float Plateau = 0.5f;
+//e^-GaussianWidth is the value of the gaussian on the radius
+static const float GaussianWidth = 4.5f;
+static const float HalfPi = 1.57079632679f;
+
+static inline float clampUnit(float value)
+{
+    return value < 0.f ? 0.f : (value > 1.f ? 1.f : value);
+}
+
+//cos(x) for x in [0, pi/2], the polynomial is vectorized in contrary with std::cos
+static inline float cosQuarter(float x)
+{
+    float x2 = x * x;
+
+    return 1.f + x2 * (-1.f / 2 + x2 * (1.f / 24 + x2 * (-1.f / 720 + x2 * (1.f / 40320))));
+}
+
+//e^-x for x in [0, GaussianWidth], computed as (e^(-x/8))^8
+static inline float expNegative(float x)
+{
+    float y = x * 0.125f;
+    float e = 1.f - y * (1.f - y * (1.f / 2 - y * (1.f / 6 - y * (1.f / 24 - y * (1.f / 120)))));
+
+    e = e * e;
+    e = e * e;
+
+    return e * e;
+}
+
+void compute(const float *centres, float *scales, int count,
+             float position, float radius, float zoomFactor, Falloff falloff)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    //t is 0 on the plateau and 1 on the radius
+    float span = radius - Plateau;
+    float invSpan = 1.f / (span > 0.01f ? span : 0.01f);
+    float amount = zoomFactor - 1.f;
+
+    switch (falloff) {
+    case Cosine:
+        for (int i=0; i<count; ++i) {
+            float t = clampUnit((std::fabs(centres[i] - position) - Plateau) * invSpan);
+            float c = cosQuarter(t * HalfPi);
+
+            scales[i] = 1.f + amount * c * c;
+        }
+        break;
+    case Gaussian: {
+        //the tail is removed so that the curve reaches 0 on the radius
+        float tail = expNegative(GaussianWidth);
+        float invHead = 1.f / (1.f - tail);
+
+        for (int i=0; i<count; ++i) {
+            float t = clampUnit((std::fabs(centres[i] - position) - Plateau) * invSpan);
+            float g = (expNegative(GaussianWidth * t * t) - tail) * invHead;
+
+            scales[i] = 1.f + amount * g;
+        }
+        break;
+    }
+    case Linear:
+    default:
+        for (int i=0; i<count; ++i) {
+            float t = clampUnit((std::fabs(centres[i] - position) - Plateau) * invSpan);
+
+            scales[i] = 1.f + amount * (1.f - t);
+        }
+        break;
+    }
+}
+
+}
+
+}
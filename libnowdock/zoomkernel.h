@@ -0,0 +1,30 @@
+#ifndef ZOOMKERNEL_H
+#define ZOOMKERNEL_H
+
+namespace NowDock
+{
+
+/*
+ * The zoom curve that is evaluated for all the items around the mouse
+ * at once. The centres are measured in item slots from the hovered item,
+ * e.g. -1 is its left neighbour, and the loops work on contiguous float
+ * arrays without branches so that the compiler can vectorize them.
+ */
+namespace ZoomKernel
+{
+
+enum Falloff {
+    Linear = 0, /** the original dock zoom with radius 1.5 */
+    Cosine,
+    Gaussian
+};
+
+//scales[i] = 1 + (zoomFactor - 1) * falloff(|centres[i] - position| / radius)
+void compute(const float *centres, float *scales, int count,
+             float position, float radius, float zoomFactor, Falloff falloff);
+
+}
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+#include "zoomlookuptable.h"
+
+#include <QtMath>
+
+namespace NowDock
+{
+
+//the mouse positions inside the hovered item that are distinguished,
+//about one for each pixel of the usual icon sizes
+static const int Steps = 64;
+
+ZoomLookupTable::ZoomLookupTable() :
+    m_valid(false),
+    m_iconMargin(0),
+    m_iconSize(0),
+    m_reach(0),
+    m_maximumLengthIncrease(0),
+    m_radius(0),
+    m_zoomFactor(0),
+    m_falloff(ZoomKernel::Linear)
+{
+}
+
+void ZoomLookupTable::build(float zoomFactor, float radius, ZoomKernel::Falloff falloff, int iconSize, int iconMargin)
+{
+    if (m_valid && (m_zoomFactor == zoomFactor) && (m_radius == radius) && (m_falloff == falloff)
+            && (m_iconSize == iconSize) && (m_iconMargin == iconMargin)) {
+        return;
+    }
+
+    m_valid = true;
+    m_zoomFactor = zoomFactor;
+    m_radius = radius;
+    m_falloff = falloff;
+    m_iconSize = iconSize;
+    m_iconMargin = iconMargin;
+
+    //the hovered item is the slot 0 and it is zoomed up to 0.5 from its center
+    m_reach = qCeil(radius - 0.5);
+
+    int slots = 2 * m_reach + 1;
+    float realSize = iconSize + iconMargin;
+
+    QVector<float> centres(slots);
+
+    for (int i=0; i<slots; ++i) {
+        centres[i] = i - m_reach;
+    }
+
+    m_scales.resize((Steps + 1) * slots);
+    m_lengthIncreases.resize(Steps + 1);
+    m_maximumLengthIncrease = 0;
+
+    for (int r=0; r<=Steps; ++r) {
+        float *rowScales = m_scales.data() + r * slots;
+
+        ZoomKernel::compute(centres.constData(), rowScales, slots,
+                            float(r) / Steps - 0.5f, radius, zoomFactor, falloff);
+
+        float increase = 0;
+
+        for (int i=0; i<slots; ++i) {
+            //two decimals are enough and avoid tiny scale changes
+            rowScales[i] = qRound(rowScales[i] * 100) / 100.f;
+            increase += (rowScales[i] - 1) * realSize;
+        }
+
+        m_lengthIncreases[r] = increase;
+        m_maximumLengthIncrease = qMax(m_maximumLengthIncrease, increase);
+    }
+}
+
+bool ZoomLookupTable::isValid() const
+{
+    return m_valid;
+}
+
+int ZoomLookupTable::reach() const
+{
+    return m_reach;
+}
+
+int ZoomLookupTable::row(float offset) const
+{
+    return qBound(0, qRound(offset * Steps), Steps);
+}
+
+float ZoomLookupTable::scale(int row, int slot) const
+{
+    if (!m_valid || (qAbs(slot) > m_reach)) {
+        return 1;
+    }
+
+    return m_scales.at(row * (2 * m_reach + 1) + slot + m_reach);
+}
+
+float ZoomLookupTable::lengthIncrease(int row) const
+{
+    return m_valid ? m_lengthIncreases.at(row) : 0;
+}
+
+float ZoomLookupTable::maximumLengthIncrease() const
+{
+    return m_maximumLengthIncrease;
+}
+
+}
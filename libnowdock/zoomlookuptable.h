@@ -0,0 +1,58 @@
+#ifndef ZOOMLOOKUPTABLE_H
+#define ZOOMLOOKUPTABLE_H
+
+#include <QVector>
+
+#include "zoomkernel.h"
+
+namespace NowDock
+{
+
+/*
+ * The zoom scales of the item slots around the hovered item for every
+ * quantized mouse position inside it. It is built once for the zoom
+ * configuration and hovering afterwards only reads a row of the table.
+ */
+class ZoomLookupTable {
+public:
+    ZoomLookupTable();
+
+    //it is rebuilt only when the configuration has changed
+    void build(float zoomFactor, float radius, ZoomKernel::Falloff falloff, int iconSize, int iconMargin);
+
+    bool isValid() const;
+
+    //the slots on each side of the hovered item
+    int reach() const;
+
+    //offset is the mouse position inside the hovered item, from 0 to 1
+    int row(float offset) const;
+
+    //the scale of the slot, -reach() ... reach(), for the row
+    float scale(int row, int slot) const;
+
+    //how much longer than normal the layout becomes for the row
+    float lengthIncrease(int row) const;
+    float maximumLengthIncrease() const;
+
+private:
+    bool m_valid;
+
+    int m_iconMargin;
+    int m_iconSize;
+    int m_reach;
+
+    float m_maximumLengthIncrease;
+    float m_radius;
+    float m_zoomFactor;
+
+    ZoomKernel::Falloff m_falloff;
+
+    //rows of 2*reach+1 scales
+    QVector<float> m_scales;
+    QVector<float> m_lengthIncreases;
+};
+
+}
+
+#endif
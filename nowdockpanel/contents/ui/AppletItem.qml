@@ -38,9 +38,12 @@ Item {
     property bool lockZoom: false
     property bool isInternalViewSplitter: false
     property bool isZoomed: false
+    //the dock window finds the hovered applet itself, the mouse area is used only out of it
+    property bool hoverAccepted: (!nowDock) && canBeHovered && (!lockZoom) && plasmoid.immutable
+    property bool containsMouse: layoutsContainer.parentMagicWinFlag ? (magicWin.hoveredItem === container)
+                                                                     : appletMouseArea.containsMouse
 
     property int animationTime: root.durationTime* (1.2 *units.shortDuration) // 70
-    property int hoveredIndex: layoutsContainer.hoveredIndex
     property int index: -1
     property int appletMargin: (applet && (applet.pluginName === "org.kde.store.nowdock.plasmoid"))
                                || isInternalViewSplitter
@@ -67,7 +70,6 @@ Item {
                                  ((applet.pluginName === "org.kde.store.nowdock.plasmoid") ||
                                   (applet.pluginName === "org.kde.plasma.systemtray")) ? wrapper : wrapperContainer
 
-    property alias containsMouse: appletMouseArea.containsMouse
     property alias pressed: appletMouseArea.pressed
 
 
@@ -116,19 +118,18 @@ Item {
     function interceptNowDockUpdateScale(dIndex, newScale, step){
         if(plasmoid.immutable){
             if(dIndex === -1){
-                layoutsContainer.updateScale(index-1,newScale, step);
+                zoomEngine.updateScale(index-1,newScale, step);
             }
             else if(dIndex === root.tasksCount){
                 //   debCounter++;
                 //   console.log(debCounter+ " "+dIndex+" "+newScale+" received...");
-                layoutsContainer.updateScale(index+1,newScale, step);
+                zoomEngine.updateScale(index+1,newScale, step);
             }
         }
     }
 
-    function clearZoom(){
-        if(wrapper)
-            wrapper.zoomScale = 1;
+    function calculateScales(currentMousePosition){
+        wrapper.calculateScales(currentMousePosition);
     }
 
     function checkCanBeHovered(){
@@ -142,6 +143,14 @@ Item {
         }
     }
 
+    function updateHoverItem(){
+        if (hoverAccepted && (index >= 0)) {
+            magicWin.setHoverItem(index, container);
+        } else {
+            magicWin.removeHoverItem(container);
+        }
+    }
+
     ///END functions
 
     //BEGIN connections
@@ -151,9 +160,18 @@ Item {
         }
     }
 
-    onHoveredIndexChanged:{
-        if ( (Math.abs(hoveredIndex-index) > 1)||(hoveredIndex == -1) )
-            wrapper.zoomScale = 1;
+    onContainsMouseChanged: {
+        if(!containsMouse){
+            hiddenSpacerLeft.nScale = 0;
+            hiddenSpacerRight.nScale = 0;
+        }
+    }
+
+    onHoverAcceptedChanged: updateHoverItem();
+
+    onIndexChanged: {
+        zoomEngine.setItem(index, wrapper);
+        updateHoverItem();
     }
 
     onNowDockChanged: {
@@ -179,12 +197,12 @@ Item {
     Component.onCompleted: {
         checkIndex();
         root.updateIndexes.connect(checkIndex);
-        root.clearZoomSignal.connect(clearZoom);
     }
 
     Component.onDestruction: {
+        zoomEngine.removeItem(wrapper);
+        magicWin.removeHoverItem(container);
         root.updateIndexes.disconnect(checkIndex);
-        root.clearZoomSignal.disconnect(clearZoom);
     }
 
     ///END connections
@@ -262,6 +280,13 @@ Item {
             property bool disableScaleHeight: false
             property bool immutable: plasmoid.immutable
 
+            //used from the zoom engine
+            property bool zoomAccept: ((canBeHovered && !lockZoom) || container.nowDock)
+                                      && applet && (applet.status !== PlasmaCore.Types.HiddenStatus) ? true : false
+            property bool zoomForward: (applet && (applet.status === PlasmaCore.Types.HiddenStatus))
+                                       || container.isInternalViewSplitter ? true : false
+            property bool zoomExternal: container.nowDock ? true : false
+
             property int appletMinimumWidth: applet && applet.Layout ?  applet.Layout.minimumWidth : -1
             property int appletMinimumHeight: applet && applet.Layout ? applet.Layout.minimumHeight : -1
 
@@ -294,6 +319,9 @@ Item {
             property real center: width / 2
             property real zoomScale: 1
 
+            property alias leftSpacerScale: hiddenSpacerLeft.nScale
+            property alias rightSpacerScale: hiddenSpacerRight.nScale
+
             property alias index: container.index
             // property int pHeight: applet ? applet.Layout.preferredHeight : -10
 
@@ -520,9 +548,21 @@ Item {
                 }
             }
 
-            ///Shadow in applets
+            ///Shadow in applets, it is captured and blurred at the normal size of the
+            ///applet and it is only scaled while the applet is zoomed, so it is blurred
+            ///again only when the contents of the applet change
             Loader{
-                anchors.fill: container.appletWrapper
+                id: shadowLoader
+                anchors.centerIn: container.appletWrapper
+                width: container.appletWrapper.width / wrapper.zoomScaleWidth
+                height: container.appletWrapper.height / wrapper.zoomScaleHeight
+
+                transform: Scale{
+                    origin.x: shadowLoader.width / 2
+                    origin.y: shadowLoader.height / 2
+                    xScale: wrapper.zoomScaleWidth
+                    yScale: wrapper.zoomScaleHeight
+                }
 
                 active: container.applet
                         &&((plasmoid.configuration.shadows === 1 /*Locked Applets*/
@@ -530,15 +570,31 @@ Item {
                            || (plasmoid.configuration.shadows === 2 /*All Applets*/
                                && (applet.pluginName !== "org.kde.store.nowdock.plasmoid")))
 
-                sourceComponent: DropShadow{
+                sourceComponent: Item{
                     anchors.fill: parent
-                    color: "#ff080808"
-                    samples: 2 * radius
-                    source: container.applet
-                    radius: shadowSize
-                    verticalOffset: 2
 
-                    property int shadowSize : Math.ceil(root.iconSize / 12)
+                    ShaderEffectSource{
+                        id: shadowSource
+                        anchors.fill: parent
+                        hideSource: false
+                        //the zoomed contents are not captured, the normal ones are scaled
+                        live: wrapper.zoomScale === 1
+                        sourceItem: container.applet
+                        textureSize: Qt.size(width, height)
+                        visible: false
+                    }
+
+                    DropShadow{
+                        anchors.fill: parent
+                        cached: true
+                        color: "#ff080808"
+                        samples: 2 * radius
+                        source: shadowSource
+                        radius: shadowSize
+                        verticalOffset: 2
+
+                        property int shadowSize : Math.ceil(root.iconSize / 12)
+                    }
                 }
             }
 
@@ -546,7 +602,7 @@ Item {
                 id:hoveredImage
                 anchors.fill: wrapperContainer
                 enabled: opacity != 0 ? true : false
-                opacity: appletMouseArea.containsMouse ? 1 : 0
+                opacity: container.containsMouse ? 1 : 0
 
                 brightness: 0.25
                 source: wrapperContainer
@@ -586,102 +642,7 @@ Item {
             }
 
             function calculateScales( currentMousePosition ){
-                var distanceFromHovered = Math.abs(index - layoutsContainer.hoveredIndex);
-
-                // A new algorithm tryig to make the zoom calculation only once
-                // and at the same time fixing glitches
-                if ((distanceFromHovered == 0)&&
-                        (currentMousePosition  > 0) ){
-
-                    var rDistance = Math.abs(currentMousePosition  - center);
-
-                    //check if the mouse goes right or down according to the center
-                    var positiveDirection =  ((currentMousePosition  - center) >= 0 );
-
-
-                    //finding the zoom center e.g. for zoom:1.7, calculates 0.35
-                    var zoomCenter = (root.zoomFactor - 1) / 2
-
-                    //computes the in the scale e.g. 0...0.35 according to the mouse distance
-                    //0.35 on the edge and 0 in the center
-                    var firstComputation = (rDistance / center) * zoomCenter;
-
-                    //calculates the scaling for the neighbour tasks
-                    var bigNeighbourZoom = Math.min(1 + zoomCenter + firstComputation, root.zoomFactor);
-                    var smallNeighbourZoom = Math.max(1 + zoomCenter - firstComputation, 1);
-
-                    bigNeighbourZoom = Number(bigNeighbourZoom.toFixed(2));
-                    smallNeighbourZoom = Number(smallNeighbourZoom.toFixed(2));
-
-                    var leftScale;
-                    var rightScale;
-
-                    if(positiveDirection === true){
-                        rightScale = bigNeighbourZoom;
-                        leftScale = smallNeighbourZoom;
-                    }
-                    else {
-                        rightScale = smallNeighbourZoom;
-                        leftScale = bigNeighbourZoom;
-                    }
-
-
-                    //   console.log("--------------")
-                    //  console.debug(leftScale + "  " + rightScale + " " + index);
-                    //activate messages to update the the neighbour scales
-                    layoutsContainer.updateScale(index-1, leftScale, 0);
-                    layoutsContainer.updateScale(index+1, rightScale, 0);
-                    //these messages interfere when an applet is hidden, that is why I disabled them
-                    //  currentLayout.updateScale(index-2, 1, 0);
-                    //   currentLayout.updateScale(index+2, 1, 0);
-
-                    //Left hiddenSpacer
-                    if((index === 0 )&&(layoutsContainer.count > 1)){
-                        hiddenSpacerLeft.nScale = leftScale - 1;
-                    }
-
-                    //Right hiddenSpacer  ///there is one more item in the currentLayout ????
-                    if((index === layoutsContainer.count - 1 )&&(layoutsContainer.count>1)){
-                        hiddenSpacerRight.nScale =  rightScale - 1;
-                    }
-
-                    zoomScale = root.zoomFactor;
-                }
-
-            } //scale
-
-
-            function signalUpdateScale(nIndex, nScale, step){
-                if(container && (container.index === nIndex)){
-                    if ( ((canBeHovered && !lockZoom ) || container.nowDock)
-                            && (applet && applet.status !== PlasmaCore.Types.HiddenStatus)
-                            //&& (index != currentLayout.hoveredIndex)
-                            ){
-                        if(!container.nowDock){
-                            if(nScale >= 0)
-                                zoomScale = nScale + step;
-                            else
-                                zoomScale = zoomScale + step;
-                        }
-                        else{
-                            if(layoutsContainer.hoveredIndex<container.index)
-                                nowDock.updateScale(0, nScale, step);
-                            else if(layoutsContainer.hoveredIndex>=container.index)
-                                nowDock.updateScale(root.tasksCount-1, nScale, step);
-                        }
-                    }  ///if the applet is hidden must forward its scale events to its neighbours
-                    else if ((applet && (applet.status === PlasmaCore.Types.HiddenStatus))
-                             || container.isInternalViewSplitter){
-                        if(layoutsContainer.hoveredIndex>index)
-                            layoutsContainer.updateScale(index-1, nScale, step);
-                        else if((layoutsContainer.hoveredIndex<index))
-                            layoutsContainer.updateScale(index+1, nScale, step);
-                    }
-                }
-            }
-
-            Component.onCompleted: {
-                layoutsContainer.updateScale.connect(signalUpdateScale);
+                zoomEngine.hover(index, currentMousePosition, width);
             }
         }// Main task area // id:wrapper
 
@@ -717,8 +678,8 @@ Item {
         id: appletMouseArea
 
         anchors.fill: parent
-        enabled: (!nowDock)&&(canBeHovered)&&(!lockZoom)&&(plasmoid.immutable)
-        hoverEnabled: plasmoid.immutable && (!nowDock) && canBeHovered ? true : false
+        enabled: hoverAccepted
+        hoverEnabled: hoverAccepted && !layoutsContainer.parentMagicWinFlag
         propagateComposedEvents: true
 
         property bool pressed: false
@@ -728,13 +689,6 @@ Item {
             mouse.accepted = false;
         }
 
-        onContainsMouseChanged: {
-            if(!containsMouse){
-                hiddenSpacerLeft.nScale = 0;
-                hiddenSpacerRight.nScale = 0;
-            }
-        }
-
         onEntered: {
             layoutsContainer.hoveredIndex = index;
             //            mouseEntered = true;
@@ -135,7 +135,7 @@ MouseArea {
             if (item && item !== placeHolder) {
                 //      placeHolder.width = item.width;
                 //     placeHolder.height = item.height;
-                placeHolder.parent = configurationArea;
+                //the placeholder is only restacked inside the layout
                 var posInItem = mapToItem(item, mouse.x, mouse.y);
 
                 if ((plasmoid.formFactor === PlasmaCore.Types.Vertical && posInItem.y < item.height/2) ||
@@ -10,7 +10,6 @@ NowDock.PanelWindow{
     id: window
 
     property bool inStartup: root.inStartup
-    property bool normalState : false  // this is being set from updateMaskArea
 
     property int animationSpeed: root.durationTime * 1.2 * units.longDuration
     property int length: root.isVertical ? screenGeometry.height : screenGeometry.width
@@ -20,7 +19,6 @@ NowDock.PanelWindow{
     property int iconMarginOriginal: 0.12*plasmoid.configuration.iconSize
     property int statesLineSizeOriginal: root.nowDock ? Math.ceil( plasmoid.configuration.iconSize/13 ) : 0
 
-    property int thicknessAutoHidden: 8
     property int thicknessMid: root.statesLineSize + (1 + (0.65 * (root.zoomFactor-1)))*(root.iconSize+root.iconMargin) //needed in some animations
     property int thicknessNormal: root.statesLineSize + root.iconSize + root.iconMargin + 1
     property int thicknessZoom: root.statesLineSize + ((root.iconSize+root.iconMargin) * root.zoomFactor) + 2
@@ -32,6 +30,32 @@ NowDock.PanelWindow{
 
 
     childrenLength: root.isHorizontal ? mainLayout.width : mainLayout.height
+
+    //mask area inputs
+    alignment: plasmoid.configuration.panelPosition === NowDock.PanelWindow.Double ?
+                   NowDock.PanelWindow.Double : root.panelAlignment
+    contentsAnimated: (root.appletsAnimations !== 0) || (root.animationsNeedBothAxis !== 0)
+                      || (root.animationsNeedLength !== 0)
+    contentsHovered: (root.nowDockHoveredIndex !== -1) || (layoutsContainer.hoveredIndex !== -1)
+    contentsLength: {
+        if (plasmoid.configuration.panelPosition === NowDock.PanelWindow.Double) {
+            return root.isHorizontal ? layoutsContainer.width : layoutsContainer.height;
+        }
+
+        return root.isHorizontal ? mainLayout.width : mainLayout.height;
+    }
+    edgeSpacing: root.panelEdgeSpacing
+    lengthAnimated: mainLayout.animatedLength
+    thicknessAnimated: root.animationsNeedThickness > 0
+    maskThicknessAutoHidden: 8
+    maskThicknessMid: thicknessMidOriginal
+    maskThicknessNormal: thicknessNormalOriginal
+    maskThicknessZoom: thicknessZoomOriginal
+    //the Now Dock plasmoid zooms its tasks itself so its extent is not known
+    zoomLengthIncrease: !root.nowDock && (plasmoid.configuration.panelPosition !== NowDock.PanelWindow.Double) ?
+                            zoomEngine.maximumLengthIncrease : -1
+    hideDelay: plasmoid.configuration.hideDelay
+    inputMaskOnly: plasmoid.configuration.inputMaskOnly
     immutable: plasmoid.immutable
     location: plasmoid.location
     panelVisibility: plasmoid.configuration.panelVisibility
@@ -62,6 +86,15 @@ NowDock.PanelWindow{
         }
     }
 
+    onHoveredIndexChanged: root.hoverApplet();
+    onHoveredOffsetChanged: root.hoverApplet();
+
+    onHoverLeft: {
+        if (!root.containsMouse()) {
+            root.clearZoom();
+        }
+    }
+
     onImmutableChanged: updateMaskArea();
 
     onInStartupChanged: {
@@ -154,143 +187,6 @@ NowDock.PanelWindow{
         }
     }
 
-    function updateMaskArea() {
-        if (!windowSystem.compositingActive) {
-            return;
-        }
-
-        var localX = 0;
-        var localY = 0;
-
-        normalState = (root.nowDockHoveredIndex === -1) && (layoutsContainer.hoveredIndex === -1)
-                && (root.appletsAnimations === 0)
-                && (root.animationsNeedBothAxis === 0) && (root.animationsNeedLength === 0)
-                && (!mainLayout.animatedLength)
-
-        // debug maskArea criteria
-        //console.log(root.nowDockHoveredIndex + ", " + layoutsContainer.hoveredIndex + ", "
-        //         + root.appletsAnimations+ ", "
-        //         + root.animationsNeedBothAxis + ", " + root.animationsNeedLength + ", " + root.animationsNeedThickness +", "
-        //         + mainLayout.animatedLength);
-
-        var tempLength = root.isHorizontal ? width : height;
-        var tempThickness = root.isHorizontal ? height : width;
-
-        var space = root.panelEdgeSpacing + 10;
-
-        if (normalState) {
-            //count panel length
-            if(root.isHorizontal) {
-                tempLength = plasmoid.configuration.panelPosition === NowDock.PanelWindow.Double ? layoutsContainer.width + 0.5*space : mainLayout.width + space;
-            } else {
-                tempLength = plasmoid.configuration.panelPosition === NowDock.PanelWindow.Double ? layoutsContainer.height + 0.5*space : mainLayout.height + space;
-            }
-
-            tempThickness = thicknessNormalOriginal;
-
-            if (root.animationsNeedThickness > 0) {
-                tempThickness = thicknessMidOriginal;
-            }
-
-            if (window.isAutoHidden && (panelVisibility === NowDock.PanelWindow.AutoHide)) {
-                tempThickness = thicknessAutoHidden;
-            }
-
-            if (!immutable) {
-                tempThickness = 2;
-            }
-
-            //configure x,y based on plasmoid position and root.panelAlignment(Alignment)
-            if ((plasmoid.location === PlasmaCore.Types.BottomEdge) || (plasmoid.location === PlasmaCore.Types.TopEdge)) {
-                if (plasmoid.location === PlasmaCore.Types.BottomEdge) {
-                    localY = window.height - tempThickness;
-                } else if (plasmoid.location === PlasmaCore.Types.TopEdge) {
-                    localY = 0;
-                }
-
-                if (plasmoid.configuration.panelPosition === NowDock.PanelWindow.Double) {
-                    localX = (window.width/2) - (layoutsContainer.width/2) - 0.25*space;
-                } else if (root.panelAlignment === NowDock.PanelWindow.Left) {
-                    localX = 0;
-                } else if (root.panelAlignment === NowDock.PanelWindow.Center) {
-                    localX = (window.width/2) - (mainLayout.width/2) - (space/2);
-                } else if (root.panelAlignment === NowDock.PanelWindow.Right) {
-                    localX = window.width - mainLayout.width - (space/2);
-                }
-            } else if ((plasmoid.location === PlasmaCore.Types.LeftEdge) || (plasmoid.location === PlasmaCore.Types.RightEdge)){
-                if (plasmoid.location === PlasmaCore.Types.LeftEdge) {
-                    localX = 0;
-                } else if (plasmoid.location === PlasmaCore.Types.RightEdge) {
-                    localX = window.width - tempThickness;
-                }
-
-                if (plasmoid.configuration.panelPosition === NowDock.PanelWindow.Double) {
-                    localY = (window.height/2) - (layoutsContainer.height/2) - 0.25*space;
-                } else if (root.panelAlignment === NowDock.PanelWindow.Top) {
-                    localY = 0;
-                } else if (root.panelAlignment === NowDock.PanelWindow.Center) {
-                    localY = (window.height/2) - (mainLayout.height/2) - (space/2);
-                } else if (root.panelAlignment === NowDock.PanelWindow.Bottom) {
-                    localY = window.height - mainLayout.height - (space/2);
-                }
-            }
-        } else {
-            if(root.isHorizontal)
-                tempLength = screenGeometry.width;
-            else
-                tempLength = screenGeometry.height;
-
-            //grow only on length and not thickness
-            if(mainLayout.animatedLength) {
-                tempThickness = thicknessNormalOriginal;
-
-                if (root.animationsNeedThickness > 0) {
-                    tempThickness = thicknessMidOriginal;
-                }
-
-                //configure the x,y position based on thickness
-                if(plasmoid.location === PlasmaCore.Types.RightEdge)
-                    localX = window.width - tempThickness;
-                else if(plasmoid.location === PlasmaCore.Types.BottomEdge)
-                    localY = window.height - tempThickness;
-            } else{
-                //use all thickness space
-                tempThickness = thicknessZoomOriginal;
-            }
-        }
-
-        var maskLength = maskArea.width; //in Horizontal
-        if (root.isVertical) {
-            maskLength = maskArea.height;
-        }
-
-        var maskThickness = maskArea.height; //in Horizontal
-        if (root.isVertical) {
-            maskThickness = maskArea.width;
-        }
-
-        // console.log("Not updating mask...");
-        if( maskArea.x !== localX || maskArea.y !== localY
-                || maskLength !== tempLength || maskThickness !== tempThickness) {
-
-            // console.log("Updating mask...");
-            var newMaskArea = Qt.rect(-1,-1,0,0);
-            newMaskArea.x = localX;
-            newMaskArea.y = localY;
-
-            if (isHorizontal) {
-                newMaskArea.width = tempLength;
-                newMaskArea.height = tempThickness;
-            } else {
-                newMaskArea.width = tempThickness;
-                newMaskArea.height = tempLength;
-            }
-
-            maskArea = newMaskArea;
-        }
-
-    }
-
     function updateTransientThickness() {
         var thickness;
 
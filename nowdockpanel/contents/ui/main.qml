@@ -29,8 +29,6 @@ import org.kde.plasma.plasmoid 2.0
 
 import org.kde.nowdock 0.1 as NowDock
 
-import "LayoutManager.js" as LayoutManager
-
 DragDrop.DropArea {
     id: root
 
@@ -62,7 +60,7 @@ DragDrop.DropArea {
     property int animationsNeedLength: 0 // animations need length, e.g. adding a task
     property int animationsNeedThickness: 0 // animations need thickness, e.g. bouncing animation
     property int appletsAnimations: 0 //zoomed applets it is used basically on masking for magic window
-    property int automaticIconSizeBasedSize: -1 //it is not set, this is the defautl
+    property int automaticIconSizeBasedSize: iconSizeSolver.automaticIconSize //-1 when it is not set, this is the default
     property int iconSize: (automaticIconSizeBasedSize > 0 && plasmoid.immutable) ? Math.min(automaticIconSizeBasedSize, plasmoid.configuration.iconSize) :
                                                                                     plasmoid.configuration.iconSize
     property int iconStep: 8
@@ -86,7 +84,7 @@ DragDrop.DropArea {
 
 
     property var iconsArray: [16, 22, 32, 48, 64, 96, 128, 256]
-    property var layoutManager: LayoutManager
+    property QtObject layoutManager: layoutsManager
 
     property Item dragOverlay
     property Item toolBox
@@ -396,13 +394,13 @@ DragDrop.DropArea {
         }
 
         var relevantLayout = mainLayout.mapFromItem(root, event.x, event.y);
-        LayoutManager.insertAtCoordinates(dndSpacer, relevantLayout.x, relevantLayout.y)
+        layoutManager.insertAtCoordinates(dndSpacer, relevantLayout.x, relevantLayout.y)
         dndSpacer.opacity = 1;
     }
 
     onDragMove: {
         var relevantLayout = mainLayout.mapFromItem(root, event.x, event.y);
-        LayoutManager.insertAtCoordinates(dndSpacer, relevantLayout.x, relevantLayout.y)
+        layoutManager.insertAtCoordinates(dndSpacer, relevantLayout.x, relevantLayout.y)
         dndSpacer.opacity = 1;
     }
 
@@ -462,11 +460,7 @@ DragDrop.DropArea {
 
     Component.onCompleted: {
         //  currentLayout.isLayoutHorizontal = isHorizontal
-        LayoutManager.plasmoid = plasmoid;
-        LayoutManager.root = root;
-        LayoutManager.layout = mainLayout;
-        LayoutManager.lastSpacer = lastSpacer;
-        LayoutManager.restore();
+        restoreApplets();
         containmentSizeSyncTimer.restart();
         plasmoid.action("configure").visible = !plasmoid.immutable;
         plasmoid.action("configure").enabled = !plasmoid.immutable;
@@ -483,11 +477,11 @@ DragDrop.DropArea {
 
     Containment.onAppletAdded: {
         addApplet(applet, x, y);
-        LayoutManager.save();
+        layoutManager.save();
     }
 
     Containment.onAppletRemoved: {
-        LayoutManager.removeApplet(applet);
+        layoutManager.removeApplet(applet);
         var flexibleFound = false;
         for (var i = 0; i < mainLayout.children.length; ++i) {
             var applet = mainLayout.children[i].applet;
@@ -502,7 +496,7 @@ DragDrop.DropArea {
             lastSpacer.parent = mainLayout;
         }
 
-        LayoutManager.save();
+        layoutManager.save();
         magicWin.removeAppletItem(applet);
     }
 
@@ -563,6 +557,12 @@ DragDrop.DropArea {
 
     //////////////START OF FUNCTIONS
     function addApplet(applet, x, y) {
+        var container = createAppletContainer(applet);
+
+        addContainerInLayout(container, applet, x, y);
+    }
+
+    function createAppletContainer(applet) {
         var container = appletContainerComponent.createObject(root)
 
         container.applet = applet;
@@ -579,22 +579,22 @@ DragDrop.DropArea {
             return applet.status !== PlasmaCore.Types.HiddenStatus || (!plasmoid.immutable && plasmoid.userConfiguring)
         })
 
-        addContainerInLayout(container, applet, x, y);
-
         // adding the AppletQuickItem to the Now Dock in order to be
         // used for right clicking events
         magicWin.addAppletItem(applet);
+
+        return container;
     }
 
     function addContainerInLayout(container, applet, x, y){
         // Is there a DND placeholder? Replace it!
         if (dndSpacer.parent === mainLayout) {
-            LayoutManager.insertBefore(dndSpacer, container);
+            layoutManager.insertBefore(dndSpacer, container);
             dndSpacer.parent = root;
             return;
             // If the provided position is valid, use it.
         } else if (x >= 0 && y >= 0) {
-            var index = LayoutManager.insertAtCoordinates(container, x , y);
+            var index = layoutManager.insertAtCoordinates(container, x , y);
 
             // Fall through to determining an appropriate insert position.
         } else {
@@ -626,7 +626,7 @@ DragDrop.DropArea {
             }
 
             if (before) {
-                LayoutManager.insertBefore(before, container);
+                layoutManager.insertBefore(before, container);
 
                 // Fall through to adding at the end.
             } else {
@@ -712,11 +712,13 @@ DragDrop.DropArea {
 
         layoutsContainer.currentSpot = -1000;
         layoutsContainer.hoveredIndex = -1;
+        //only the items that the engine has zoomed are restored
+        zoomEngine.clear();
         root.clearZoomSignal();
     }
 
     function containsMouse(){
-        var result = root.outsideContainsMouse();
+        var result = layoutsContainer.parentMagicWinFlag ? (magicWin.hoveredIndex !== -1) : root.outsideContainsMouse();
 
         if(result)
             return true;
@@ -733,6 +735,24 @@ DragDrop.DropArea {
         return false;
     }
 
+    //the dock window has found a new hovered applet or mouse position
+    function hoverApplet(){
+        var applet = magicWin.hoveredItem;
+
+        if (!applet || !layoutsContainer.parentMagicWinFlag) {
+            return;
+        }
+
+        if ((layoutsContainer.hoveredIndex === magicWin.hoveredIndex)
+                && (Math.abs(layoutsContainer.currentSpot - magicWin.hoveredOffset) < applet.animationStep)) {
+            return;
+        }
+
+        layoutsContainer.hoveredIndex = magicWin.hoveredIndex;
+        layoutsContainer.currentSpot = magicWin.hoveredOffset;
+        applet.calculateScales(magicWin.hoveredOffset);
+    }
+
     function internalViewSplitterExists(){
         for (var container in mainLayout.children) {
             var item = mainLayout.children[container];
@@ -820,91 +840,48 @@ DragDrop.DropArea {
     }
 
     function updateAutomaticIconSize() {
-        if (magicWin && magicWin.normalState && !animatedLengthTimer.running && plasmoid.immutable
-                && (iconSize===plasmoid.configuration.iconSize || iconSize === automaticIconSizeBasedSize) ) {
-            var layoutLength;
-            var maxLength = magicWin.maximumLength;
-            // console.log("------Entered check-----");
+        iconSizeSolver.update();
+    }
 
-            if (root.isVertical) {
-                layoutLength = (plasmoid.configuration.panelPosition === 10) ? mainLayout.height+secondLayout.height : mainLayout.height
-            } else {
-                layoutLength = (plasmoid.configuration.panelPosition === 10) ? mainLayout.width+secondLayout.width : mainLayout.width
-            }
+    //all the applets are placed in the layouts at once, the layouts, the mask
+    //and the thickness are updated only once for all of them
+    function restoreApplets() {
+        var applets = layoutManager.beginRestore(plasmoid.applets);
+        var containers = [];
 
-            var toShrinkLimit = maxLength-(zoomFactor*(iconSize+2*iconMargin));
-            var toGrowLimit = maxLength-1.5*(zoomFactor*(iconSize+2*iconMargin));
+        for (var i = 0; i < applets.length; ++i) {
+            var container = createAppletContainer(applets[i]);
+            //the animations are enabled when the startup has finished
+            container.animationsEnabled = false;
+            containers.push(container);
+        }
 
-            if (layoutLength > toShrinkLimit) { //must shrink
-                //  console.log("step3");
-                var nextIconSize = plasmoid.configuration.iconSize;
+        //add the splitter in the correct position if it exists
+        var splitterPosition = plasmoid.configuration.splitterPosition;
 
-                do {
-                    nextIconSize = nextIconSize - iconStep;
-                    var factor = nextIconSize / iconSize;
-                    var nextLength = factor * layoutLength;
+        if (splitterPosition !== -1) {
+            var splitter = appletContainerComponent.createObject(root);
 
-                } while ( (nextLength>toShrinkLimit) && (nextIconSize !== 16));
+            splitter.isInternalViewSplitter = true;
+            splitter.visible = true;
+            containers.splice(Math.min(splitterPosition, containers.length), 0, splitter);
+        }
 
-                automaticIconSizeBasedSize = nextIconSize;
-                //   console.log("Step 3 - found:"+automaticIconSizeBasedSize);
-            } else if ((layoutLength<toGrowLimit
-                        && (iconSize === automaticIconSizeBasedSize)) ) { //must grow probably
-                //   console.log("step4");
-                var nextIconSize2 = automaticIconSizeBasedSize;
-                var foundGoodSize = -1;
+        //the items after the splitter are moved to the second layout when it is needed
+        layoutManager.restore(containers, plasmoid.immutable);
 
-                do {
-                    nextIconSize2 = nextIconSize2 + iconStep;
-                    var factor2 = nextIconSize2 / automaticIconSizeBasedSize;
-                    var nextLength2 = factor2 * layoutLength;
+        startupTimer.restart();
+        updateIndexes();
 
-                    if (nextLength2 < toGrowLimit) {
-                        foundGoodSize = nextIconSize2;
-                    }
-                } while ( (nextLength2<toGrowLimit) && (nextIconSize2 !== plasmoid.configuration.iconSize ));
+        magicWin.updateMaskArea();
 
-                if (foundGoodSize > 0) {
-                    if (foundGoodSize === plasmoid.configuration.iconSize) {
-                        automaticIconSizeBasedSize = -1;
-                    } else {
-                        automaticIconSizeBasedSize = foundGoodSize;
-                    }
-                    //      console.log("Step 4 - found:"+automaticIconSizeBasedSize);
-                } else {
-                    //     console.log("Step 4 - did not found...");
-                }
-            }
+        if (!plasmoid.immutable || !windowSystem.compositingActive) {
+            magicWin.updateTransientThickness();
         }
     }
 
     function updateLayouts(){
-        if(plasmoid.immutable){
-            var splitter = -1;
-
-            var totalChildren = mainLayout.children.length;
-            for (var i=0; i<totalChildren; ++i) {
-                var item;
-                if(splitter === -1)
-                    item = mainLayout.children[i];
-                else{
-                    item = mainLayout.children[splitter+1];
-                    item.parent = secondLayout;
-                }
-
-                if(item.isInternalViewSplitter) {
-                    splitter = i;
-                }
-            }
-        }
-        else{
-            var totalChildren2 = secondLayout.children.length;
-
-            for (var i=totalChildren2-1; i>=0; --i) {
-                var item2 = secondLayout.children[0];
-                item2.parent = mainLayout;
-            }
-        }
+        layoutManager.splitLayouts(plasmoid.immutable);
 
         updateIndexes();
     }
@@ -942,6 +919,70 @@ DragDrop.DropArea {
         id:windowSystem
     }
 
+    NowDock.IconSizeSolver{
+        id: iconSizeSolver
+        enabled: magicWin && magicWin.normalState && !animatedLengthTimer.running && plasmoid.immutable
+                 && (root.iconSize === plasmoid.configuration.iconSize || root.iconSize === automaticIconSize)
+        iconMargin: root.iconMargin
+        iconSize: root.iconSize
+        //the length of the layouts is not used while the applets are zoomed
+        //or their zoom is animated back
+        zoomed: (root.nowDockHoveredIndex !== -1) || (layoutsContainer.hoveredIndex !== -1)
+                || (root.appletsAnimations !== 0)
+        layoutLength: {
+            if (root.isVertical) {
+                return (plasmoid.configuration.panelPosition === NowDock.PanelWindow.Double) ? mainLayout.height+secondLayout.height : mainLayout.height
+            } else {
+                return (plasmoid.configuration.panelPosition === NowDock.PanelWindow.Double) ? mainLayout.width+secondLayout.width : mainLayout.width
+            }
+        }
+        maximumLength: magicWin ? magicWin.maximumLength : 0
+        maximumSize: plasmoid.configuration.iconSize
+        minimumSize: root.iconsArray[0]
+        step: root.iconStep
+        zoomFactor: root.zoomFactor
+    }
+
+    NowDock.LayoutManager{
+        id: layoutsManager
+        appletOrder: plasmoid.configuration.appletOrder
+        horizontal: root.isHorizontal
+        lastSpacer: lastSpacer
+        lockedZoomApplets: plasmoid.configuration.lockedZoomApplets
+        mainLayout: mainLayout
+        root: root
+        secondLayout: secondLayout
+        splitterEnabled: plasmoid.configuration.panelPosition === NowDock.PanelWindow.Double
+        splitterPosition: plasmoid.configuration.splitterPosition
+
+        onAppletOrderChanged: plasmoid.configuration.appletOrder = appletOrder;
+        onLockedZoomAppletsChanged: plasmoid.configuration.lockedZoomApplets = lockedZoomApplets;
+        onSplitterPositionChanged: plasmoid.configuration.splitterPosition = splitterPosition;
+    }
+
+    NowDock.ZoomEngine{
+        id: zoomEngine
+        falloff: plasmoid.configuration.zoomFalloff
+        hoveredIndex: layoutsContainer.hoveredIndex
+        iconMargin: root.iconMargin
+        iconSize: root.iconSize
+        radius: plasmoid.configuration.zoomRadius
+        zoomFactor: root.zoomFactor
+
+        //the Now Dock plasmoid zooms its own tasks
+        onExternalScaleRequested: {
+            if (!root.nowDock) {
+                return;
+            }
+
+            if (hoveredIndex < index) {
+                nowDock.updateScale(0, scale, step);
+            } else {
+                nowDock.updateScale(root.tasksCount-1, scale, step);
+            }
+        }
+    }
+
     ////END interfaces
 
     ///////////////BEGIN components
@@ -1024,7 +1065,6 @@ DragDrop.DropArea {
     Item{
         id: layoutsContainer
 
-        signal updateScale(int delegateIndex, real newScale, real step)
         property bool parentMagicWinFlag: plasmoid.immutable && magicWin && !root.inStartup && windowSystem.compositingActive
         //&& !(root.inStartup && magicWin.panelVisibility === NowDock.PanelWindow.AutoHide)
 
@@ -1226,7 +1266,8 @@ DragDrop.DropArea {
         }
     }
 
-    //Timer to check if the mouse is still inside the ListView
+    //Timer to check if the mouse is still inside the applets when
+    //they are hovered out of the dock window
     Timer{
         id:checkListHovered
         repeat:false;